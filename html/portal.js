@@ -776,6 +776,18 @@ function _updateDeviceConfigUI(config) {
                 regionSelect.value = config.region;
             }
         }
+        if (config.hub_role !== undefined) {
+            const hubRoleSelect = document.getElementById('hubRole');
+            if (hubRoleSelect) {
+                hubRoleSelect.value = config.hub_role;
+            }
+        }
+        if (config.push_token_display !== undefined) {
+            const pushTokenField = document.getElementById('pushToken');
+            if (pushTokenField && !pushTokenField.value) {
+                pushTokenField.value = config.push_token_display;
+            }
+        }
         initialDeviceConfigLoaded = true;
     }
 }
@@ -5,9 +5,12 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
+#include "InlineFunction.h"
 #include "posthog/parsers/InsightParser.h"
 
 /**
@@ -15,6 +18,7 @@
  */
 enum class EventType {
     INSIGHT_DATA_RECEIVED,
+    INSIGHT_DATA_PUSHED,
     INSIGHT_FORCE_REFRESH,
     INSIGHT_DATA_ERROR,
     INSIGHT_NETWORK_STATE_CHANGED,
@@ -28,7 +32,8 @@ enum class EventType {
     OTA_PROCESS_START,
     OTA_PROCESS_END,
     CARD_CONFIG_CHANGED,
-    CARD_TITLE_UPDATED
+    CARD_TITLE_UPDATED,
+    API_CONFIG_CHANGED
 };
 
 /**
@@ -63,22 +68,237 @@ struct Event {
 
 /**
  * @brief Callback function type for event handlers
+ *
+ * Stored inline; subscribers capture little more than `this`.
  */
-using EventCallback = std::function<void(const Event&)>;
+using EventCallback = InlineFunction<void(const Event&), 16>;
+
+/**
+ * @brief Event topic: an event type, optionally narrowed to one insight
+ * 
+ * Keys topic subscriptions and coalescing of queued events.
+ */
+struct SubscriptionKey {
+    EventType type;       // Event type to receive
+    String insightId;     // Insight to receive events for, empty for all
+    
+    bool operator==(const SubscriptionKey& other) const {
+        return type == other.type && insightId == other.insightId;
+    }
+};
+
+/**
+ * @brief FNV-1a hash over the event type and insight ID
+ */
+struct SubscriptionKeyHash {
+    size_t operator()(const SubscriptionKey& key) const {
+        uint32_t hash = 2166136261u ^ static_cast<uint32_t>(key.type);
+        hash *= 16777619u;
+        for (const char* c = key.insightId.c_str(); *c; c++) {
+            hash ^= static_cast<uint8_t>(*c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+};
+
+class EventQueue;
+
+/**
+ * @brief Handle for one subscription; unsubscribes when destroyed
+ * 
+ * Move-only. Keep the handle alive exactly as long as whatever the callback
+ * captures, typically as a member of the subscribing object. Discarding it
+ * unsubscribes immediately.
+ */
+class [[nodiscard]] EventSubscription {
+public:
+    EventSubscription() : _queue(nullptr), _id(0) {}
+    ~EventSubscription() { reset(); }
+    
+    EventSubscription(EventSubscription&& other) noexcept;
+    EventSubscription& operator=(EventSubscription&& other) noexcept;
+    
+    // Delete copy constructor and assignment operator
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator=(const EventSubscription&) = delete;
+    
+    /**
+     * @brief Unsubscribe now
+     * 
+     * Safe from inside any callback. From another task, waits for a call
+     * of this callback that is already running, so don't reset while
+     * holding a lock the callback itself takes.
+     */
+    void reset();
+    
+    /**
+     * @brief Check whether the handle still owns a subscription
+     */
+    explicit operator bool() const { return _queue != nullptr; }
+    
+private:
+    friend class EventQueue;
+    EventSubscription(EventQueue* queue, uint32_t id) : _queue(queue), _id(id) {}
+    
+    EventQueue* _queue;   ///< Queue the subscription lives in, null once released
+    uint32_t _id;         ///< Subscriber ID within that queue
+};
 
 /**
  * @brief Thread-safe event queue for handling system events
+ * 
+ * Events live in a fixed pool of preallocated slots. Publishing moves the
+ * event into a free slot and only the slot index travels through the
+ * FreeRTOS queue, so String and shared_ptr members are never byte-copied.
+ * Slots are reset and returned to the pool once every subscriber has run.
+ * 
+ * Callbacks run on the event task without the subscriber tables locked, so
+ * they may subscribe and unsubscribe freely.
+ * 
+ * Coalescable event types carry state where only the latest value matters.
+ * Publishing one while an event for the same (type, insightId) is still
+ * queued overwrites that event in its slot and keeps its queue position, so
+ * a burst of refreshes costs one parse and one render.
+ * 
+ * Queued slots wait in one of two lanes. Control events (WiFi, card
+ * configuration, OTA) always dispatch before insight data, so a backlog of
+ * payloads never delays a state change. The event task sleeps until a
+ * publish wakes it, then drains every ready event.
  */
 class EventQueue {
+public:
+    /**
+     * @brief Dispatch lanes, highest priority first
+     */
+    enum Lane : uint8_t {
+        LANE_CONTROL,   ///< System state changes the UI reacts to
+        LANE_DATA,      ///< Insight payloads and refresh requests
+        LANE_COUNT
+    };
+    
+    static constexpr size_t LATENCY_BUCKET_COUNT = 8;   ///< Histogram buckets per lane
+    static const uint32_t LATENCY_BUCKET_LIMITS_US[LATENCY_BUCKET_COUNT - 1]; ///< Upper bounds, last bucket is open
+    
+    /**
+     * @brief Per-lane dispatch counters
+     */
+    struct LaneStats {
+        size_t queued;                                  ///< Events waiting in the lane
+        uint32_t dispatched;                            ///< Events dispatched since boot
+        uint32_t maxLatencyUs;                          ///< Longest publish-to-dispatch wait
+        uint32_t latencyHistogram[LATENCY_BUCKET_COUNT]; ///< Publish-to-dispatch waits by bucket
+    };
+    
+    /**
+     * @brief Pool usage counters
+     */
+    struct Stats {
+        size_t capacity;      ///< Number of event slots
+        size_t inUse;         ///< Slots currently holding an undispatched event
+        size_t highWater;     ///< Most slots ever in use at once
+        uint32_t published;   ///< Events accepted since boot
+        uint32_t dropped;     ///< Events rejected because the pool was full
+        uint32_t coalesced;   ///< Events that replaced a queued one instead of taking a slot
+        LaneStats lanes[LANE_COUNT];
+    };
+
 private:
-    QueueHandle_t eventQueue;
-    SemaphoreHandle_t callbackMutex;
-    std::vector<EventCallback> eventCallbacks;
+    QueueHandle_t laneQueues[LANE_COUNT];  // Indices of slots waiting for dispatch, per lane
+    QueueHandle_t freeSlots;               // Indices of unused slots
+    std::vector<Event> eventPool;          // Preallocated event storage
+    std::vector<uint32_t> slotQueuedAt;    // micros() when each slot was queued
+    /**
+     * @brief One registered callback
+     */
+    struct Subscriber {
+        SubscriptionKey key;      ///< Topic, unused for catch-all subscribers
+        bool catchAll;            ///< Receives every event
+        bool active;              ///< Cleared on unsubscribe, checked before each call
+        EventCallback callback;
+    };
+    using SubscriberPtr = std::shared_ptr<Subscriber>;
+    
+    SemaphoreHandle_t callbackMutex;             // Guards the subscriber tables and runningSubscriber
+    std::vector<SubscriberPtr> eventCallbacks;   // Subscribers to every event
+    std::unordered_map<SubscriptionKey, std::vector<SubscriberPtr>, SubscriptionKeyHash> topicCallbacks;
+    std::unordered_map<uint32_t, SubscriberPtr> subscribers;  // All subscribers by handle ID
+    uint32_t nextSubscriberId;
+    const Subscriber* runningSubscriber;         // Callback the event task is inside, if any
+    std::vector<SubscriberPtr> dispatchList;     // Event task only: subscribers for the current event
+    
+    SemaphoreHandle_t coalesceMutex;   // Guards coalesceSlots and the slots it points at
+    std::unordered_map<SubscriptionKey, uint16_t, SubscriptionKeyHash> coalesceSlots;  // Queued coalescable events
+    
+    std::atomic<uint32_t> publishedCount;
+    std::atomic<uint32_t> droppedCount;
+    std::atomic<uint32_t> coalescedCount;
+    std::atomic<size_t> highWaterMark;
+    
+    /**
+     * @brief Latency counters for one lane, written by the event task only
+     */
+    struct LaneCounters {
+        std::atomic<uint32_t> dispatched;
+        std::atomic<uint32_t> maxLatencyUs;
+        std::atomic<uint32_t> histogram[LATENCY_BUCKET_COUNT];
+    };
+    LaneCounters laneCounters[LANE_COUNT];
     
     static void eventProcessingTask(void* parameter);
     TaskHandle_t taskHandle;
     bool isRunning;
     
+    /**
+     * @brief Return a dispatched slot to the pool, releasing its payload
+     * @param slot Index of the slot
+     */
+    void releaseSlot(uint16_t slot);
+    
+    /**
+     * @brief Stop a dequeued slot from being coalesced into
+     * @param slot Index just received from eventQueue
+     * 
+     * Once this returns no publisher touches the slot until it is released.
+     */
+    void claimSlot(uint16_t slot);
+    
+    /**
+     * @brief Dispatch the oldest event of the highest non-empty lane
+     * @return false if every lane was empty
+     */
+    bool dispatchNext();
+    
+    /**
+     * @brief Add one publish-to-dispatch wait to a lane's histogram
+     */
+    void recordLatency(Lane lane, uint32_t latencyUs);
+    
+    /**
+     * @brief Append the subscribers to one topic to dispatchList
+     * 
+     * Caller must hold callbackMutex.
+     */
+    void collectTopic(const SubscriptionKey& key);
+    
+    /**
+     * @brief Run every subscriber interested in an event
+     */
+    void dispatch(const Event& event);
+    
+    /**
+     * @brief Register a subscriber and hand out its handle
+     */
+    EventSubscription addSubscriber(SubscriberPtr subscriber);
+    
+    /**
+     * @brief Remove a subscriber, waiting out a call in progress on the event task
+     * @param id Subscriber ID from the handle
+     */
+    void unsubscribe(uint32_t id);
+    
+    friend class EventSubscription;
+    
 public:
     EventQueue(size_t queueSize = 10);
     ~EventQueue();
@@ -118,18 +338,69 @@ public:
     /**
      * @brief Alternative method to publish a pre-constructed Event
      * 
-     * @param event The event to publish
+     * @param event The event to publish, copied into a pool slot
      * @return true if the event was successfully queued
      * @return false if the queue is full
      */
     bool publishEvent(const Event& event);
     
     /**
-     * @brief Subscribe to events
+     * @brief Publish a pre-constructed Event without copying its payload
+     * 
+     * @param event The event to publish, moved into a pool slot
+     * @return true if the event was successfully queued or replaced a queued one
+     * @return false if the queue is full (event is left untouched)
+     */
+    bool publishEvent(Event&& event);
+    
+    /**
+     * @brief Check whether a newer event of this type supersedes a queued one
+     * @param eventType Type to check
+     * @return true if only the latest event per insight needs dispatching
+     */
+    static bool isCoalescable(EventType eventType);
+    
+    /**
+     * @brief Get the lane events of a type are dispatched from
+     * @param eventType Type to check
+     * @return Lane for the type
+     */
+    static Lane laneFor(EventType eventType);
+    
+    /**
+     * @brief Subscribe to all events
      * 
      * @param callback Function to call when an event is processed
+     * @return Handle that keeps the subscription alive
+     * 
+     * Prefer the topic overloads; a catch-all subscriber runs for every event.
+     */
+    EventSubscription subscribe(EventCallback callback);
+    
+    /**
+     * @brief Subscribe to one event type
+     * 
+     * @param eventType Type of events to receive
+     * @param callback Function to call when a matching event is processed
+     * @return Handle that keeps the subscription alive
+     */
+    EventSubscription subscribe(EventType eventType, EventCallback callback);
+    
+    /**
+     * @brief Subscribe to one event type for a single insight
+     * 
+     * @param eventType Type of events to receive
+     * @param insightId Insight the events must refer to
+     * @param callback Function to call when a matching event is processed
+     * @return Handle that keeps the subscription alive
+     */
+    EventSubscription subscribe(EventType eventType, const String& insightId, EventCallback callback);
+    
+    /**
+     * @brief Get event pool usage and per-lane latency
+     * @return Snapshot of the pool counters
      */
-    void subscribe(EventCallback callback);
+    Stats getStats() const;
     
     /**
      * @brief Start the event processing task
@@ -140,4 +411,4 @@ public:
      * @brief Stop the event processing task
      */
     void end();
-}; 
\ No newline at end of file
+};
\ No newline at end of file
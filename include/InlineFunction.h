@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity>
+class InlineFunction;
+
+/**
+ * @brief Move-only callable wrapper that never allocates
+ *
+ * Works like std::function, except the callable is always stored inside the
+ * wrapper. A lambda whose captures exceed Capacity bytes fails to compile
+ * instead of silently falling back to the heap, so every hot-path callback
+ * has a known, fixed cost.
+ *
+ * Being move-only, it can hold lambdas that capture move-only state, and
+ * moving one (into a queue slot, say) never copies its captures.
+ *
+ * @tparam R Return type
+ * @tparam Args Argument types
+ * @tparam Capacity Bytes of inline storage for the callable's captures
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+    InlineFunction() noexcept : _ops(nullptr) {}
+    InlineFunction(std::nullptr_t) noexcept : _ops(nullptr) {}
+
+    template <typename F,
+              typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, InlineFunction>::value>::type>
+    InlineFunction(F&& func) : _ops(nullptr) {
+        static_assert(sizeof(Fn) <= Capacity,
+                      "Callable captures too much for this InlineFunction; capture less or raise its capacity");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                      "Callable is over-aligned for InlineFunction storage");
+        new (_storage) Fn(std::forward<F>(func));
+        _ops = &OpsFor<Fn>::ops;
+    }
+
+    InlineFunction(InlineFunction&& other) noexcept : _ops(other._ops) {
+        if (_ops) {
+            _ops->move(_storage, other._storage);
+            other._ops = nullptr;
+        }
+    }
+
+    InlineFunction& operator=(InlineFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other._ops) {
+                other._ops->move(_storage, other._storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    // Move-only: copying would duplicate captured state
+    InlineFunction(const InlineFunction&) = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    ~InlineFunction() { reset(); }
+
+    /**
+     * @brief Call the stored callable
+     *
+     * Like std::function, calling an empty wrapper is undefined; check it first.
+     */
+    R operator()(Args... args) const {
+        return _ops->invoke(const_cast<unsigned char*>(_storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return _ops != nullptr; }
+
+    /**
+     * @brief Destroy the stored callable, leaving the wrapper empty
+     */
+    void reset() noexcept {
+        if (_ops) {
+            _ops->destroy(_storage);
+            _ops = nullptr;
+        }
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    /**
+     * @brief Type-erased operations for one callable type
+     */
+    struct Ops {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* to, void* from);   ///< Move-construct into `to`, destroy `from`
+        void (*destroy)(void* storage);
+    };
+
+    template <typename Fn>
+    struct OpsFor {
+        static R invoke(void* storage, Args&&... args) {
+            return (*static_cast<Fn*>(storage))(std::forward<Args>(args)...);
+        }
+        static void move(void* to, void* from) {
+            Fn* source = static_cast<Fn*>(from);
+            new (to) Fn(std::move(*source));
+            source->~Fn();
+        }
+        static void destroy(void* storage) {
+            static_cast<Fn*>(storage)->~Fn();
+        }
+        static constexpr Ops ops = {&OpsFor::invoke, &OpsFor::move, &OpsFor::destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[Capacity];
+    const Ops* _ops;   ///< Operations for the stored callable, null when empty
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename Fn>
+constexpr typename InlineFunction<R(Args...), Capacity>::Ops InlineFunction<R(Args...), Capacity>::OpsFor<Fn>::ops;
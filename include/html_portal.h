@@ -1158,6 +1158,18 @@ static const char PORTAL_HTML[] PROGMEM = "<!DOCTYPE html>\n"
 "                regionSelect.value = config.region;\n"
 "            }\n"
 "        }\n"
+"        if (config.hub_role !== undefined) {\n"
+"            const hubRoleSelect = document.getElementById('hubRole');\n"
+"            if (hubRoleSelect) {\n"
+"                hubRoleSelect.value = config.hub_role;\n"
+"            }\n"
+"        }\n"
+"        if (config.push_token_display !== undefined) {\n"
+"            const pushTokenField = document.getElementById('pushToken');\n"
+"            if (pushTokenField && !pushTokenField.value) {\n"
+"                pushTokenField.value = config.push_token_display;\n"
+"            }\n"
+"        }\n"
 "        initialDeviceConfigLoaded = true;\n"
 "    }\n"
 "}\n"
@@ -1420,7 +1432,23 @@ static const char PORTAL_HTML[] PROGMEM = "<!DOCTYPE html>\n"
 "                <div class=\"form-group\">\n"
 "                    <label for=\"apiKey\">API key</label>\n"
 "                    <input type=\"text\" name=\"apiKey\" id=\"apiKey\">\n"
-"                    <p class=\"tip\">Create a <a href=\"https://app.posthog.com/settings/user-api-keys\" target=\"_blank\">new API key in your project settings</a>. Give it read access to insights.</p>\n"
+"                    <p class=\"tip\">Create a <a href=\"https://app.posthog.com/settings/user-api-keyss\" target=\"_blank\">new API key in your project settings</a>. Give it read access to insights.</p>\n"
+"                </div>\n"
+"\n"
+"                <div class=\"form-group\">\n"
+"                    <label for=\"hubRole\">Sharing on this network</label>\n"
+"                    <select name=\"hubRole\" id=\"hubRole\">\n"
+"                        <option value=\"STANDALONE\">Standalone: fetch my own insights</option>\n"
+"                        <option value=\"HUB\">Hub: fetch insights and share them</option>\n"
+"                        <option value=\"FOLLOWER\">Follower: show insights shared by a hub</option>\n"
+"                    </select>\n"
+"                    <p class=\"tip\">With several DeskHogs on one network, make one a hub and the rest followers so only the hub talks to PostHog. Takes effect after a restart.</p>\n"
+"                </div>\n"
+"\n"
+"                <div class=\"form-group\">\n"
+"                    <label for=\"pushToken\">Push token</label>\n"
+"                    <input type=\"text\" name=\"pushToken\" id=\"pushToken\">\n"
+"                    <p class=\"tip\">A secret of your choosing. Local relays send it in an X-Push-Token header when they push insight data to /api/insights/push. Pushes are refused until it's set.</p>\n"
 "                </div>\n"
 "                \n"
 "                <div class=\"button-container\">\n"
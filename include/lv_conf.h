@@ -80,7 +80,9 @@
 
 #if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
     /** Size of memory available for `lv_malloc()` in bytes (>= 2kB) */
+    #ifndef LV_MEM_SIZE /* The native env raises it, as objects are larger with 64-bit pointers */
     #define LV_MEM_SIZE (32 * 1024U)          /**< [bytes] - Migrated from old config (was 32k) */
+    #endif
 
     /** Size of the memory expand for `lv_malloc()` in bytes */
     #define LV_MEM_POOL_EXPAND_SIZE 0         // Default
@@ -166,6 +168,7 @@
 #if LV_USE_DRAW_SW == 1
     /* Selectively disable color format support */
     #define LV_DRAW_SW_SUPPORT_RGB565       1 // Keep enabled for LV_COLOR_DEPTH 16
+    #define LV_DRAW_SW_SUPPORT_RGB565_SWAPPED 1 // Display renders in the panel's byte order
     #define LV_DRAW_SW_SUPPORT_RGB565A8     0 // Default
     #define LV_DRAW_SW_SUPPORT_RGB888       0 // Default
     #define LV_DRAW_SW_SUPPORT_XRGB8888     0 // Default
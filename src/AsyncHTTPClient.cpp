@@ -1,4 +1,5 @@
 #include "AsyncHTTPClient.h"
+#include "TraceBuffer.h"
 #include <algorithm>
 
 AsyncHTTPClient::AsyncHTTPClient(EventQueue& eventQueue) 
@@ -9,25 +10,27 @@ AsyncHTTPClient::~AsyncHTTPClient() {
     cancelAllRequests();
 }
 
-String AsyncHTTPClient::request(const RequestConfig& config) {
+String AsyncHTTPClient::request(RequestConfig config) {
     String requestId = generateRequestId();
     
     auto request = std::make_shared<ActiveRequest>();
     request->requestId = requestId;
-    request->config = config;
+    request->config = std::move(config);
     request->startTime = millis();
     request->lastActivity = millis();
     
     // Parse URL
-    if (!parseUrl(config.url, request->host, request->port, request->path, request->config.useSSL)) {
-        Serial.printf("[AsyncHTTP] Failed to parse URL: %s\n", config.url.c_str());
+    if (!parseUrl(request->config.url, request->host, request->port, request->path, request->config.useSSL)) {
+        Serial.printf("[AsyncHTTP] Failed to parse URL: %s\n", request->config.url.c_str());
         return "";
     }
     
     // Store request
     _activeRequests[requestId] = request;
+    request->traceId = TraceBuffer::nextAsyncId();
+    TraceBuffer::asyncBegin("http.request", request->traceId);
     
-    Serial.printf("[AsyncHTTP] Queued request %s: %s\n", requestId.c_str(), config.url.c_str());
+    Serial.printf("[AsyncHTTP] Queued request %s: %s\n", requestId.c_str(), request->config.url.c_str());
     
     return requestId;
 }
@@ -177,6 +180,7 @@ void AsyncHTTPClient::startRequest(std::shared_ptr<ActiveRequest> request) {
     Serial.printf("[AsyncHTTP] Starting request %s to %s:%d\n", 
                   request->requestId.c_str(), request->host.c_str(), request->port);
     
+    TraceBuffer::asyncStep("http.connect", request->traceId, request->retryCount);
     request->state = RequestState::CONNECTING;
     request->lastActivity = millis();
 }
@@ -198,6 +202,7 @@ void AsyncHTTPClient::handleConnection(std::shared_ptr<ActiveRequest> request) {
         if (result == 1) {
             // Connected successfully
             Serial.printf("[AsyncHTTP] Connected to %s:%d\n", request->host.c_str(), request->port);
+            TraceBuffer::asyncStep("http.connected", request->traceId);
             request->state = RequestState::SENDING_REQUEST;
             request->lastActivity = millis();
         } else if (result == 0) {
@@ -265,6 +270,7 @@ void AsyncHTTPClient::sendHttpRequest(std::shared_ptr<ActiveRequest> request) {
     if (written == httpRequest.length()) {
         Serial.printf("[AsyncHTTP] Sent request %s (%d bytes)\n", 
                       request->requestId.c_str(), written);
+        TraceBuffer::asyncStep("http.sent", request->traceId, written);
         request->state = RequestState::RECEIVING_HEADERS;
         request->lastActivity = millis();
     } else {
@@ -302,6 +308,7 @@ void AsyncHTTPClient::receiveResponse(std::shared_ptr<ActiveRequest> request) {
         if (headerEndIndex != -1) {
             // Parse headers
             parseResponseHeaders(request, request->responseHeaders.substring(0, headerEndIndex + 4));
+            TraceBuffer::asyncStep("http.headers", request->traceId, request->statusCode);
             
             // Start receiving body if there's remaining data
             String remainingData = request->responseHeaders.substring(headerEndIndex + 4);
@@ -371,6 +378,34 @@ void AsyncHTTPClient::parseResponseHeaders(std::shared_ptr<ActiveRequest> reques
     
     Serial.printf("[AsyncHTTP] Response %s: HTTP %d, Content-Length: %d\n", 
                   request->requestId.c_str(), request->statusCode, request->contentLength);
+    
+    if (request->config.onHeaders) {
+        request->config.onHeaders(headers, request->statusCode);
+    }
+}
+
+String AsyncHTTPClient::getHeaderValue(const String& headers, const char* name) {
+    size_t nameLength = strlen(name);
+    int lineStart = 0;
+    
+    while (lineStart < (int)headers.length()) {
+        int lineEnd = headers.indexOf("\r\n", lineStart);
+        if (lineEnd == -1) {
+            lineEnd = headers.length();
+        }
+        
+        // Match "<name>:" at the start of the line, ignoring case
+        if (lineEnd - lineStart > (int)nameLength && headers.charAt(lineStart + nameLength) == ':' &&
+            strncasecmp(headers.c_str() + lineStart, name, nameLength) == 0) {
+            String value = headers.substring(lineStart + nameLength + 1, lineEnd);
+            value.trim();
+            return value;
+        }
+        
+        lineStart = lineEnd + 2;
+    }
+    
+    return "";
 }
 
 void AsyncHTTPClient::completeRequest(std::shared_ptr<ActiveRequest> request) {
@@ -442,6 +477,11 @@ void AsyncHTTPClient::retryRequest(std::shared_ptr<ActiveRequest> request, const
 }
 
 void AsyncHTTPClient::cleanupRequest(std::shared_ptr<ActiveRequest> request) {
+    if (request->traceId != 0) {
+        TraceBuffer::asyncEnd("http.request", request->traceId, request->statusCode);
+        request->traceId = 0;
+    }
+    
     if (request->client) {
         request->client->stop();
         delete request->client;
@@ -472,7 +512,7 @@ void AsyncHTTPClient::checkTimeouts() {
     }
 }
 
-void AsyncHTTPClient::dispatchCallback(std::function<void()> callback) {
+void AsyncHTTPClient::dispatchCallback(InlineFunction<void(), 32> callback) {
     // Use EventQueue to safely dispatch callback to UI thread
     _eventQueue.publishEvent(EventType::UI_UPDATE_REQUESTED, "", "");
     
@@ -2,10 +2,10 @@
 
 #include <Arduino.h>
 #include <WiFiClientSecure.h>
-#include <functional>
 #include <map>
 #include <memory>
 #include "EventQueue.h"
+#include "InlineFunction.h"
 
 /**
  * @class AsyncHTTPClient
@@ -33,13 +33,19 @@ public:
 
     /**
      * @brief Request callback function types
+     *
+     * Stored inline, so queuing a request never allocates for its callbacks.
+     * Sized for the projected query callback, which captures a Template.
      */
-    using SuccessCallback = std::function<void(const String& response, int statusCode)>;
-    using ErrorCallback = std::function<void(const String& error, int statusCode)>;
-    using ProgressCallback = std::function<void(size_t current, size_t total)>;
+    using SuccessCallback = InlineFunction<void(const String& response, int statusCode), 64>;
+    using ErrorCallback = InlineFunction<void(const String& error, int statusCode), 64>;
+    using ProgressCallback = InlineFunction<void(size_t current, size_t total), 64>;
+    using HeadersCallback = InlineFunction<void(const String& headers, int statusCode), 64>;
 
     /**
      * @brief Request configuration
+     *
+     * Move-only, as its callbacks are.
      */
     struct RequestConfig {
         String url;
@@ -52,6 +58,7 @@ public:
         SuccessCallback onSuccess;
         ErrorCallback onError;
         ProgressCallback onProgress;
+        HeadersCallback onHeaders;      // Called once the response headers are parsed
     };
 
 private:
@@ -75,6 +82,7 @@ private:
      */
     struct ActiveRequest {
         String requestId;
+        uint32_t traceId = 0;       // Async span ID in the trace buffer
         RequestConfig config;
         RequestState state = RequestState::IDLE;
         WiFiClientSecure* client = nullptr;
@@ -109,10 +117,10 @@ public:
     
     /**
      * @brief Make an async HTTP request
-     * @param config Request configuration including URL, callbacks, etc.
+     * @param config Request configuration including URL, callbacks, etc.; moved into the request
      * @return Request ID for tracking, empty string if failed to queue
      */
-    String request(const RequestConfig& config);
+    String request(RequestConfig config);
     
     /**
      * @brief Cancel a pending request
@@ -149,6 +157,14 @@ public:
      * @param maxRetries Maximum retry attempts
      */
     void setDefaultMaxRetries(uint8_t maxRetries) { _defaultMaxRetries = maxRetries; }
+    
+    /**
+     * @brief Look up a header in a raw response header block
+     * @param headers Raw header block (status line and CRLF-separated headers)
+     * @param name Header name, matched case-insensitively
+     * @return Trimmed header value, empty string if not present
+     */
+    static String getHeaderValue(const String& headers, const char* name);
 
 private:
     EventQueue& _eventQueue;                                ///< Event queue for thread-safe callbacks
@@ -252,5 +268,5 @@ private:
      * @brief Dispatch callback to UI thread safely
      * @param callback Function to execute on UI thread
      */
-    void dispatchCallback(std::function<void()> callback);
+    void dispatchCallback(InlineFunction<void(), 32> callback);
 };
\ No newline at end of file
@@ -1,13 +1,13 @@
 #include "ConfigManager.h"
 #include "SystemController.h"
-#include <ArduinoJson.h>
 
-ConfigManager::ConfigManager() {
-    // Constructor
+ConfigManager::ConfigManager()
+    : _apiConfig(std::make_shared<const ApiConfig>()) {
 }
 
-ConfigManager::ConfigManager(EventQueue& eventQueue) {
-    _eventQueue = &eventQueue;
+ConfigManager::ConfigManager(EventQueue& eventQueue)
+    : _eventQueue(&eventQueue)
+    , _apiConfig(std::make_shared<const ApiConfig>()) {
 }
 
 void ConfigManager::setEventQueue(EventQueue* queue) {
@@ -18,7 +18,10 @@ void ConfigManager::begin() {
     // Initialize preferences
     _preferences.begin(_namespace, false);
     _insightsPrefs.begin(_insightsNamespace, false);
-    _cardPrefs.begin(_cardNamespace, false);
+    _cardStore.begin(_cardNamespace);
+    
+    // The only NVS read of the API settings; everything after uses the snapshot
+    loadApiConfig();
     
     // Check initial API configuration state
     updateApiConfigurationState();
@@ -26,12 +29,7 @@ void ConfigManager::begin() {
 
 // Private helper to check and update API configuration state
 void ConfigManager::updateApiConfigurationState() {
-    if (!_preferences.isKey(_teamIdKey) || getTeamId() == NO_TEAM_ID) {
-        SystemController::setApiState(ApiState::API_AWAITING_CONFIG);
-        return;
-    }
-    
-    if (!_preferences.isKey(_apiKeyKey) || getApiKey().isEmpty()) {
+    if (!getApiConfig()->isComplete()) {
         SystemController::setApiState(ApiState::API_AWAITING_CONFIG);
         return;
     }
@@ -40,15 +38,41 @@ void ConfigManager::updateApiConfigurationState() {
     SystemController::setApiState(ApiState::API_CONFIGURED);
 }
 
+void ConfigManager::loadApiConfig() {
+    auto config = std::make_shared<ApiConfig>();
+    if (_preferences.isKey(_teamIdKey)) {
+        config->teamId = _preferences.getInt(_teamIdKey);
+    }
+    config->apiKey = _preferences.getString(_apiKeyKey, "");
+    if (_preferences.isKey(_regionKey)) {
+        config->region = _preferences.getString(_regionKey);
+    }
+    if (_preferences.isKey(_hubRoleKey)) {
+        config->hubRole = stringToHubRole(_preferences.getString(_hubRoleKey));
+    }
+    config->pushToken = _preferences.getString(_pushTokenKey, "");
+    std::atomic_store(&_apiConfig, ApiConfigPtr(std::move(config)));
+}
+
+void ConfigManager::publishApiConfig(const ApiConfig& next) {
+    std::atomic_store(&_apiConfig, ApiConfigPtr(std::make_shared<const ApiConfig>(next)));
+    
+    if (_eventQueue != nullptr) {
+        _eventQueue->publishEvent(EventType::API_CONFIG_CHANGED, "");
+    }
+}
+
+ConfigManager::ApiConfigPtr ConfigManager::getApiConfig() const {
+    return std::atomic_load(&_apiConfig);
+}
+
 // Helper method to commit changes to flash
 void ConfigManager::commit() {
     _preferences.end();
     _insightsPrefs.end();
-    _cardPrefs.end();
     
     _preferences.begin(_namespace, false);
     _insightsPrefs.begin(_insightsNamespace, false);
-    _cardPrefs.begin(_cardNamespace, false);
 }
 
 bool ConfigManager::saveWiFiCredentials(const String& ssid, const String& password) {
@@ -127,14 +151,15 @@ void ConfigManager::setTeamId(int teamId) {
     // Commit changes
     commit();
     
+    ApiConfig next = *getApiConfig();
+    next.teamId = teamId;
+    publishApiConfig(next);
+    
     updateApiConfigurationState();
 }
 
 int ConfigManager::getTeamId() {
-    if (!_preferences.isKey(_teamIdKey)) {
-        return NO_TEAM_ID;
-    }
-    return _preferences.getInt(_teamIdKey);
+    return getApiConfig()->teamId;
 }
 
 void ConfigManager::setRegion(String region) {
@@ -143,14 +168,15 @@ void ConfigManager::setRegion(String region) {
     // Commit changes
     commit();
     
+    ApiConfig next = *getApiConfig();
+    next.region = region;
+    publishApiConfig(next);
+    
     updateApiConfigurationState();
 }
 
 String ConfigManager::getRegion() {
-    if (!_preferences.isKey(_regionKey)) {
-        return "us";
-    }
-    return _preferences.getString(_regionKey);
+    return getApiConfig()->region;
 }
 
 void ConfigManager::clearTeamId() {
@@ -159,6 +185,10 @@ void ConfigManager::clearTeamId() {
     // Commit changes
     commit();
     
+    ApiConfig next = *getApiConfig();
+    next.teamId = NO_TEAM_ID;
+    publishApiConfig(next);
+    
     SystemController::setApiState(ApiState::API_AWAITING_CONFIG);
 }
 
@@ -173,12 +203,16 @@ bool ConfigManager::setApiKey(const String& apiKey) {
     // Commit changes
     commit();
     
+    ApiConfig next = *getApiConfig();
+    next.apiKey = apiKey;
+    publishApiConfig(next);
+    
     updateApiConfigurationState();
     return true;
 }
 
 String ConfigManager::getApiKey() {
-    return _preferences.getString(_apiKeyKey, "");
+    return getApiConfig()->apiKey;
 }
 
 void ConfigManager::clearApiKey() {
@@ -187,77 +221,68 @@ void ConfigManager::clearApiKey() {
     // Commit changes
     commit();
     
+    ApiConfig next = *getApiConfig();
+    next.apiKey = "";
+    publishApiConfig(next);
+    
     SystemController::setApiState(ApiState::API_AWAITING_CONFIG);
 }
 
-std::vector<CardConfig> ConfigManager::getCardConfigs() {
-    std::vector<CardConfig> configs;
-    
-    // Check if the key exists first to avoid error logs
-    if (!_cardPrefs.isKey("config_list")) {
-        return configs; // Return empty vector if no card config stored yet
-    }
-    
-    // Get JSON string from preferences
-    String jsonString = _cardPrefs.getString("config_list", "[]");
-    
-    // Parse JSON
-    DynamicJsonDocument doc(2048);
-    DeserializationError error = deserializeJson(doc, jsonString);
+void ConfigManager::setHubRole(HubRole role) {
+    _preferences.putString(_hubRoleKey, hubRoleToString(role));
+
+    // Commit changes
+    commit();
     
-    if (error) {
-        Serial.printf("Failed to parse card configs JSON: %s\n", error.c_str());
-        return configs; // Return empty vector on parse error
+    ApiConfig next = *getApiConfig();
+    next.hubRole = role;
+    publishApiConfig(next);
+}
+
+HubRole ConfigManager::getHubRole() {
+    return getApiConfig()->hubRole;
+}
+
+bool ConfigManager::setPushToken(const String& token) {
+    if (token.length() == 0 || token.length() > MAX_PUSH_TOKEN_LENGTH) {
+        return false;
     }
-    
-    // Convert JSON array to vector of CardConfig
-    JsonArray array = doc.as<JsonArray>();
-    for (JsonVariant v : array) {
-        JsonObject obj = v.as<JsonObject>();
-        if (obj.containsKey("type") && obj.containsKey("config") && obj.containsKey("order")) {
-            CardConfig config;
-            config.type = stringToCardType(obj["type"].as<String>());
-            config.config = obj["config"].as<String>();
-            config.order = obj["order"].as<int>();
-            config.name = obj["name"].as<String>();
-            configs.push_back(config);
-        }
+    if (token == getPushToken()) {
+        return true;
     }
+
+    _preferences.putString(_pushTokenKey, token);
+
+    // Commit changes
+    commit();
     
-    return configs;
+    ApiConfig next = *getApiConfig();
+    next.pushToken = token;
+    publishApiConfig(next);
+    return true;
+}
+
+String ConfigManager::getPushToken() {
+    return getApiConfig()->pushToken;
+}
+
+std::vector<CardConfig> ConfigManager::getCardConfigs() {
+    return _cardStore.getAll();
 }
 
 bool ConfigManager::saveCardConfigs(const std::vector<CardConfig>& configs) {
-    // Create JSON document
-    DynamicJsonDocument doc(2048);
-    JsonArray array = doc.to<JsonArray>();
-    
-    // Convert vector to JSON array
-    for (const CardConfig& config : configs) {
-        JsonObject obj = array.createNestedObject();
-        obj["type"] = cardTypeToString(config.type);
-        obj["config"] = config.config;
-        obj["order"] = config.order;
-        obj["name"] = config.name;
-    }
-    
-    // Serialize to string
-    String jsonString;
-    if (serializeJson(doc, jsonString) == 0) {
-        Serial.println("Failed to serialize card configs to JSON");
+    if (!_cardStore.save(configs)) {
         return false;
     }
     
-    // Save to preferences
-    _cardPrefs.putString("config_list", jsonString);
-    
-    // Commit changes
-    commit();
-    
     // Publish event if event queue is available
     if (_eventQueue != nullptr) {
         _eventQueue->publishEvent(EventType::CARD_CONFIG_CHANGED, "");
     }
     
     return true;
+}
+
+void ConfigManager::flushCardConfigs() {
+    _cardStore.flush();
 }
\ No newline at end of file
@@ -2,9 +2,12 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <memory>
 #include <vector>
 #include "EventQueue.h"
 #include "config/CardConfig.h"
+#include "config/CardConfigStore.h"
+#include "config/HubRole.h"
 
 /**
  * @class ConfigManager
@@ -19,11 +22,37 @@
  * 
  * Uses ESP32's non-volatile storage (NVS) through Preferences library
  * with size limits enforced for all stored values.
+ * 
+ * API settings are read from NVS once in begin() and served from an
+ * immutable in-RAM snapshot. Setters write NVS, swap in a new snapshot and
+ * publish API_CONFIG_CHANGED, so readers never touch NVS.
+ * 
+ * Card configurations live in a CardConfigStore, which also serves reads
+ * from RAM and writes only the cards that changed.
  */
 class ConfigManager {
 public:
     static const int NO_TEAM_ID = -1;  // Sentinel value for no team ID
 
+    /**
+     * @struct ApiConfig
+     * @brief Immutable snapshot of the API settings
+     */
+    struct ApiConfig {
+        int teamId = NO_TEAM_ID;                  ///< Team ID or NO_TEAM_ID if not set
+        String apiKey;                            ///< API key, empty if not set
+        String region = "us";                     ///< Project region
+        HubRole hubRole = HubRole::STANDALONE;    ///< LAN sharing role
+        String pushToken;                         ///< Secret relays send with pushed insights, empty to refuse pushes
+
+        /**
+         * @brief Check whether both team ID and API key are set
+         */
+        bool isComplete() const { return teamId != NO_TEAM_ID && apiKey.length() > 0; }
+    };
+
+    using ApiConfigPtr = std::shared_ptr<const ApiConfig>;
+
     /**
      * @brief Default constructor
      */
@@ -126,9 +155,43 @@ public:
      */
     void clearApiKey();
 
+    /**
+     * @brief Store the LAN sharing role of this device
+     * @param role Standalone, hub or follower
+     * 
+     * Takes effect on the next boot.
+     */
+    void setHubRole(HubRole role);
 
     /**
-     * @brief Get all configured cards from persistent storage
+     * @brief Retrieve the LAN sharing role of this device
+     * @return The stored role, STANDALONE if not set
+     */
+    HubRole getHubRole();
+
+    /**
+     * @brief Store the token local relays must send with pushed insight data
+     * @param token Shared secret
+     * @return true if saved, false if empty or too long
+     */
+    bool setPushToken(const String& token);
+
+    /**
+     * @brief Retrieve the push token
+     * @return The stored token, empty if pushes are not set up
+     */
+    String getPushToken();
+
+    /**
+     * @brief Get the current API settings without touching NVS
+     * @return Snapshot that stays valid, and unchanged, for as long as it's held
+     * 
+     * Safe to call from any task; writers swap the snapshot atomically.
+     */
+    ApiConfigPtr getApiConfig() const;
+
+    /**
+     * @brief Get all configured cards
      * @return Vector of CardConfig objects representing enabled cards
      */
     std::vector<CardConfig> getCardConfigs();
@@ -136,10 +199,20 @@ public:
     /**
      * @brief Save card configurations to persistent storage
      * @param configs Vector of CardConfig objects to save
-     * @return true if saved successfully, false otherwise
+     * @return true if saved successfully, false if the deck is too large
+     * 
+     * Subscribers see the change at once; flash is written a moment later,
+     * once edits stop (see CardConfigStore::COMMIT_DELAY_MS).
      */
     bool saveCardConfigs(const std::vector<CardConfig>& configs);
 
+    /**
+     * @brief Write pending card configuration changes to flash now
+     * 
+     * Call before a deliberate restart.
+     */
+    void flushCardConfigs();
+
 private:
     
     /**
@@ -152,10 +225,21 @@ private:
      */
     void updateApiConfigurationState();
 
+    /**
+     * @brief Read the API settings from NVS into a fresh snapshot
+     */
+    void loadApiConfig();
+
+    /**
+     * @brief Swap in new API settings and notify subscribers
+     * @param next Settings to publish
+     */
+    void publishApiConfig(const ApiConfig& next);
+
     /**
      * @brief Ensures preferences changes are persisted to flash
      * 
-     * Closes and reopens both preference namespaces to ensure changes
+     * Closes and reopens the preference namespaces to ensure changes
      * are written to flash storage. Required after any preference modifications
      * to ensure changes survive power cycles.
      */
@@ -164,12 +248,12 @@ private:
     // Preferences instances for persistent storage
     Preferences _preferences;      ///< Main preferences storage instance
     Preferences _insightsPrefs;   ///< Separate storage for insight data
-    Preferences _cardPrefs;       ///< Separate storage for card configurations
+    CardConfigStore _cardStore;   ///< Card configurations, in their own namespace
 
     // Namespace constants for preferences organization
     const char* _namespace = "wifi_config";        ///< Namespace for WiFi and general config
     const char* _insightsNamespace = "insights";   ///< Namespace for insight data
-    const char* _cardNamespace = "cards";          ///< Namespace for card configurations
+    const char* _cardNamespace = "cards";          ///< Namespace for card configurations, owned by _cardStore
 
     // Storage keys for WiFi configuration
     const char* _ssidKey = "ssid";                ///< Key for stored WiFi SSID
@@ -180,6 +264,8 @@ private:
     const char* _teamIdKey = "team_id";           ///< Key for stored team ID
     const char* _apiKeyKey = "api_key";           ///< Key for stored API key
     const char* _regionKey = "region";           ///< Key for stored region
+    const char* _hubRoleKey = "hub_role";        ///< Key for stored LAN hub role
+    const char* _pushTokenKey = "push_token";    ///< Key for stored push token
 
 
     // Storage size limits
@@ -193,7 +279,11 @@ private:
     static const size_t MAX_API_KEY_LENGTH = 64;
     /** @brief Maximum length for insight identifier */
     static const size_t MAX_INSIGHT_ID_LENGTH = 64;
+    /** @brief Maximum length for push token */
+    static const size_t MAX_PUSH_TOKEN_LENGTH = 64;
 
     // Event system
     EventQueue* _eventQueue = nullptr;  ///< Optional event queue for state notifications
+
+    ApiConfigPtr _apiConfig;            ///< Current API settings; access only with std::atomic_load/store
 };
\ No newline at end of file
@@ -1,11 +1,65 @@
 #include "EventQueue.h"
+#include "TraceBuffer.h"
+#include <algorithm>
 
-EventQueue::EventQueue(size_t queueSize) : isRunning(false), taskHandle(nullptr) {
-    // Create the event queue
-    eventQueue = xQueueCreate(queueSize, sizeof(Event));
+EventSubscription::EventSubscription(EventSubscription&& other) noexcept
+    : _queue(other._queue)
+    , _id(other._id) {
+    other._queue = nullptr;
+}
+
+EventSubscription& EventSubscription::operator=(EventSubscription&& other) noexcept {
+    if (this != &other) {
+        reset();
+        _queue = other._queue;
+        _id = other._id;
+        other._queue = nullptr;
+    }
+    return *this;
+}
+
+void EventSubscription::reset() {
+    if (_queue != nullptr) {
+        _queue->unsubscribe(_id);
+        _queue = nullptr;
+    }
+}
+
+const uint32_t EventQueue::LATENCY_BUCKET_LIMITS_US[LATENCY_BUCKET_COUNT - 1] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+
+EventQueue::EventQueue(size_t queueSize)
+    : eventPool(queueSize)
+    , slotQueuedAt(queueSize, 0)
+    , publishedCount(0)
+    , droppedCount(0)
+    , coalescedCount(0)
+    , highWaterMark(0)
+    , nextSubscriberId(1)
+    , runningSubscriber(nullptr)
+    , taskHandle(nullptr)
+    , isRunning(false) {
+    // Only slot indices travel through the queues; each lane can hold the whole pool
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++) {
+        laneQueues[lane] = xQueueCreate(queueSize, sizeof(uint16_t));
+        
+        LaneCounters& counters = laneCounters[lane];
+        counters.dispatched = 0;
+        counters.maxLatencyUs = 0;
+        for (auto& bucket : counters.histogram) {
+            bucket = 0;
+        }
+    }
+    freeSlots = xQueueCreate(queueSize, sizeof(uint16_t));
+    
+    for (uint16_t slot = 0; slot < queueSize; slot++) {
+        xQueueSend(freeSlots, &slot, 0);
+    }
     
     // Create mutex for callback access
     callbackMutex = xSemaphoreCreateMutex();
+    coalesceMutex = xSemaphoreCreateMutex();
 }
 
 EventQueue::~EventQueue() {
@@ -13,25 +67,35 @@ EventQueue::~EventQueue() {
     end();
     
     // Clean up resources
-    if (eventQueue) {
-        vQueueDelete(eventQueue);
-        eventQueue = nullptr;
+    for (QueueHandle_t& lane : laneQueues) {
+        if (lane) {
+            vQueueDelete(lane);
+            lane = nullptr;
+        }
+    }
+    
+    if (freeSlots) {
+        vQueueDelete(freeSlots);
+        freeSlots = nullptr;
     }
     
     if (callbackMutex) {
         vSemaphoreDelete(callbackMutex);
         callbackMutex = nullptr;
     }
+    
+    if (coalesceMutex) {
+        vSemaphoreDelete(coalesceMutex);
+        coalesceMutex = nullptr;
+    }
 }
 
 bool EventQueue::publishEvent(EventType eventType, const String& insightId) {
-    Event event(eventType, insightId);
-    return publishEvent(event);
+    return publishEvent(Event(eventType, insightId));
 }
 
 bool EventQueue::publishEvent(EventType eventType, const String& insightId, std::shared_ptr<InsightParser> parser) {
-    Event event(eventType, insightId, parser);
-    return publishEvent(event);
+    return publishEvent(Event(eventType, insightId, std::move(parser)));
 }
 
 bool EventQueue::publishEvent(EventType eventType, const String& insightId, const String& jsonData) {
@@ -40,24 +104,208 @@ bool EventQueue::publishEvent(EventType eventType, const String& insightId, cons
         Serial.printf("Large JSON detected (%u bytes), handling via event\n", jsonData.length());
     }
     
-    Event event(eventType, insightId, jsonData);
-    return publishEvent(event);
+    return publishEvent(Event(eventType, insightId, jsonData));
 }
 
 bool EventQueue::publishEvent(const Event& event) {
-    // Add the event to the queue
-    if (xQueueSend(eventQueue, &event, 0) == pdPASS) {
-        return true;
+    return publishEvent(Event(event));
+}
+
+bool EventQueue::isCoalescable(EventType eventType) {
+    switch (eventType) {
+        case EventType::INSIGHT_DATA_RECEIVED:
+        case EventType::INSIGHT_DATA_PUSHED:
+        case EventType::INSIGHT_FORCE_REFRESH:
+        case EventType::INSIGHT_NETWORK_STATE_CHANGED:
+        case EventType::CARD_CONFIG_CHANGED:
+        case EventType::CARD_TITLE_UPDATED:
+        case EventType::API_CONFIG_CHANGED:
+            return true;
+        default:
+            return false;
     }
-    return false;
 }
 
-void EventQueue::subscribe(EventCallback callback) {
-    // Protect access to the callbacks vector
-    if (xSemaphoreTake(callbackMutex, portMAX_DELAY) == pdTRUE) {
-        eventCallbacks.push_back(callback);
+EventQueue::Lane EventQueue::laneFor(EventType eventType) {
+    switch (eventType) {
+        case EventType::INSIGHT_DATA_RECEIVED:
+        case EventType::INSIGHT_DATA_PUSHED:
+        case EventType::INSIGHT_FORCE_REFRESH:
+        case EventType::INSIGHT_DATA_ERROR:
+        case EventType::INSIGHT_NETWORK_STATE_CHANGED:
+        case EventType::CARD_TITLE_UPDATED:
+            return LANE_DATA;
+        default:
+            return LANE_CONTROL;
+    }
+}
+
+bool EventQueue::publishEvent(Event&& event) {
+    bool coalescable = isCoalescable(event.type);
+    if (coalescable) {
+        xSemaphoreTake(coalesceMutex, portMAX_DELAY);
+        auto it = coalesceSlots.find(SubscriptionKey{event.type, event.insightId});
+        if (it != coalesceSlots.end()) {
+            // Still queued: overwrite it, its index is already in a lane
+            TraceBuffer::instant("event.coalesce", static_cast<uint32_t>(event.type));
+            eventPool[it->second] = std::move(event);
+            xSemaphoreGive(coalesceMutex);
+            ++publishedCount;
+            ++coalescedCount;
+            return true;
+        }
+    }
+    
+    uint16_t slot;
+    if (xQueueReceive(freeSlots, &slot, 0) != pdPASS) {
+        if (coalescable) {
+            xSemaphoreGive(coalesceMutex);
+        }
+        uint32_t dropped = ++droppedCount;
+        Serial.printf("[EventQueue] Pool full, dropping event type %d for %s (%u dropped)\n",
+                      static_cast<int>(event.type), event.insightId.c_str(), dropped);
+        return false;
+    }
+    
+    // The slot is ours until its index comes back through freeSlots
+    if (coalescable) {
+        coalesceSlots[SubscriptionKey{event.type, event.insightId}] = slot;
+    }
+    Lane lane = laneFor(event.type);
+    TraceBuffer::instant("event.publish", static_cast<uint32_t>(event.type));
+    slotQueuedAt[slot] = micros();
+    eventPool[slot] = std::move(event);
+    
+    size_t inUse = eventPool.size() - uxQueueMessagesWaiting(freeSlots);
+    size_t previous = highWaterMark.load();
+    while (inUse > previous && !highWaterMark.compare_exchange_weak(previous, inUse)) {
+    }
+    
+    // Can't fail: the index queue is as deep as the pool
+    xQueueSend(laneQueues[lane], &slot, 0);
+    if (coalescable) {
+        xSemaphoreGive(coalesceMutex);
+    }
+    ++publishedCount;
+    
+    if (taskHandle != nullptr) {
+        xTaskNotifyGive(taskHandle);
+    }
+    return true;
+}
+
+void EventQueue::claimSlot(uint16_t slot) {
+    // A publisher may be overwriting the slot right now, so read it under the lock
+    xSemaphoreTake(coalesceMutex, portMAX_DELAY);
+    const Event& event = eventPool[slot];
+    if (isCoalescable(event.type)) {
+        auto it = coalesceSlots.find(SubscriptionKey{event.type, event.insightId});
+        if (it != coalesceSlots.end() && it->second == slot) {
+            coalesceSlots.erase(it);
+        }
+    }
+    xSemaphoreGive(coalesceMutex);
+}
+
+void EventQueue::releaseSlot(uint16_t slot) {
+    // Drop the payload now rather than when the slot is next reused
+    eventPool[slot] = Event();
+    xQueueSend(freeSlots, &slot, 0);
+}
+
+EventQueue::Stats EventQueue::getStats() const {
+    Stats stats;
+    stats.capacity = eventPool.size();
+    stats.inUse = eventPool.size() - uxQueueMessagesWaiting(freeSlots);
+    stats.highWater = highWaterMark.load();
+    stats.published = publishedCount.load();
+    stats.dropped = droppedCount.load();
+    stats.coalesced = coalescedCount.load();
+    
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++) {
+        const LaneCounters& counters = laneCounters[lane];
+        LaneStats& laneStats = stats.lanes[lane];
+        laneStats.queued = uxQueueMessagesWaiting(laneQueues[lane]);
+        laneStats.dispatched = counters.dispatched.load();
+        laneStats.maxLatencyUs = counters.maxLatencyUs.load();
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+            laneStats.latencyHistogram[i] = counters.histogram[i].load();
+        }
+    }
+    return stats;
+}
+
+EventSubscription EventQueue::subscribe(EventCallback callback) {
+    return addSubscriber(std::make_shared<Subscriber>(Subscriber{SubscriptionKey{}, true, true, std::move(callback)}));
+}
+
+EventSubscription EventQueue::subscribe(EventType eventType, EventCallback callback) {
+    return subscribe(eventType, String(), std::move(callback));
+}
+
+EventSubscription EventQueue::subscribe(EventType eventType, const String& insightId, EventCallback callback) {
+    return addSubscriber(std::make_shared<Subscriber>(
+        Subscriber{SubscriptionKey{eventType, insightId}, false, true, std::move(callback)}));
+}
+
+EventSubscription EventQueue::addSubscriber(SubscriberPtr subscriber) {
+    if (xSemaphoreTake(callbackMutex, portMAX_DELAY) != pdTRUE) {
+        return EventSubscription();
+    }
+    
+    uint32_t id = nextSubscriberId++;
+    if (subscriber->catchAll) {
+        eventCallbacks.push_back(subscriber);
+    } else {
+        topicCallbacks[subscriber->key].push_back(subscriber);
+    }
+    subscribers[id] = std::move(subscriber);
+    
+    xSemaphoreGive(callbackMutex);
+    return EventSubscription(this, id);
+}
+
+void EventQueue::unsubscribe(uint32_t id) {
+    if (xSemaphoreTake(callbackMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    auto it = subscribers.find(id);
+    if (it == subscribers.end()) {
         xSemaphoreGive(callbackMutex);
+        return;
     }
+    
+    SubscriberPtr subscriber = std::move(it->second);
+    subscribers.erase(it);
+    subscriber->active = false;
+    
+    if (subscriber->catchAll) {
+        eventCallbacks.erase(std::remove(eventCallbacks.begin(), eventCallbacks.end(), subscriber),
+                             eventCallbacks.end());
+    } else {
+        auto topic = topicCallbacks.find(subscriber->key);
+        if (topic != topicCallbacks.end()) {
+            auto& list = topic->second;
+            list.erase(std::remove(list.begin(), list.end(), subscriber), list.end());
+            if (list.empty()) {
+                topicCallbacks.erase(topic);
+            }
+        }
+    }
+    
+    // A callback already running on the event task may still use what it
+    // captured; the caller is about to free that, so let the call finish.
+    // From inside a callback the running one is the caller's own frame.
+    if (xTaskGetCurrentTaskHandle() != taskHandle) {
+        while (runningSubscriber == subscriber.get()) {
+            xSemaphoreGive(callbackMutex);
+            vTaskDelay(1);
+            xSemaphoreTake(callbackMutex, portMAX_DELAY);
+        }
+    }
+    
+    xSemaphoreGive(callbackMutex);
 }
 
 void EventQueue::begin() {
@@ -88,24 +336,97 @@ void EventQueue::end() {
     }
 }
 
+void EventQueue::collectTopic(const SubscriptionKey& key) {
+    auto it = topicCallbacks.find(key);
+    if (it != topicCallbacks.end()) {
+        dispatchList.insert(dispatchList.end(), it->second.begin(), it->second.end());
+    }
+}
+
+void EventQueue::dispatch(const Event& event) {
+    if (xSemaphoreTake(callbackMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    // Catch-all subscribers, then handlers for this type, and for this insight
+    dispatchList.assign(eventCallbacks.begin(), eventCallbacks.end());
+    collectTopic(SubscriptionKey{event.type, String()});
+    if (!event.insightId.isEmpty()) {
+        collectTopic(SubscriptionKey{event.type, event.insightId});
+    }
+    
+    // Tables stay unlocked while a callback runs; dispatchList keeps each
+    // subscriber alive even if it is removed mid-dispatch
+    for (const SubscriberPtr& subscriber : dispatchList) {
+        if (!subscriber->active) {
+            continue;
+        }
+        runningSubscriber = subscriber.get();
+        xSemaphoreGive(callbackMutex);
+        
+        subscriber->callback(event);
+        
+        xSemaphoreTake(callbackMutex, portMAX_DELAY);
+        runningSubscriber = nullptr;
+    }
+    
+    xSemaphoreGive(callbackMutex);
+    dispatchList.clear();
+}
+
+bool EventQueue::dispatchNext() {
+    uint16_t slot;
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++) {
+        if (xQueueReceive(laneQueues[lane], &slot, 0) != pdPASS) {
+            continue;
+        }
+        
+        // Process the event by calling all registered callbacks
+        claimSlot(slot);
+        recordLatency(static_cast<Lane>(lane), micros() - slotQueuedAt[slot]);
+        {
+            TraceBuffer::Span span("event.dispatch", static_cast<uint32_t>(eventPool[slot].type));
+            dispatch(eventPool[slot]);
+        }
+        releaseSlot(slot);
+        return true;
+    }
+    return false;
+}
+
+void EventQueue::recordLatency(Lane lane, uint32_t latencyUs) {
+    LaneCounters& counters = laneCounters[lane];
+    
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT - 1 && latencyUs > LATENCY_BUCKET_LIMITS_US[bucket]) {
+        bucket++;
+    }
+    counters.histogram[bucket]++;
+    counters.dispatched++;
+    if (latencyUs > counters.maxLatencyUs.load()) {
+        counters.maxLatencyUs = latencyUs;
+    }
+}
+
 void EventQueue::eventProcessingTask(void* parameter) {
     EventQueue* self = static_cast<EventQueue*>(parameter);
-    Event event;
     
     // Process events in a loop
     while (self->isRunning) {
-        // Wait for an event (block until an event arrives)
-        if (xQueueReceive(self->eventQueue, &event, pdMS_TO_TICKS(100)) == pdPASS) {
-            // Process the event by calling all registered callbacks
-            if (xSemaphoreTake(self->callbackMutex, portMAX_DELAY) == pdTRUE) {
-                for (const auto& callback : self->eventCallbacks) {
-                    callback(event);
-                }
-                xSemaphoreGive(self->callbackMutex);
-            }
+        // Drain everything that is ready, control lane first. Publishers
+        // that never let up still can't keep the idle task off this core:
+        // after a pool's worth of events, sleep a tick before carrying on.
+        size_t handled = 0;
+        while (handled < self->eventPool.size() && self->dispatchNext()) {
+            handled++;
+        }
+        
+        if (handled == self->eventPool.size()) {
+            vTaskDelay(1);
+        } else {
+            // Sleep until a publish wakes us; the timeout lets end() take effect
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
         }
-        // Small delay to prevent CPU hogging
-        vTaskDelay(1);
     }
     
     // Task cleanup
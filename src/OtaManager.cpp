@@ -862,6 +862,9 @@ void OtaManager::_updateTaskRunner(void* pvParameters) {
             } else {
                 self->_setUpdateStatus(UpdateStatus::State::SUCCESS, "Update successful! Rebooting...", 100);
                 Serial.println("OtaManager: [_updateTaskRunner] Update successful. Rebooting...");
+                if (self->_beforeRestart) {
+                    self->_beforeRestart();
+                }
                 delay(1000); // Give a moment for serial message to get out
                 ESP.restart();
             }
@@ -12,6 +12,7 @@
 
 // Add these includes for FreeRTOS mutex
 #include <freertos/semphr.h>
+#include <functional>
 
 // Forward declarations if needed, e.g., if using WiFiClientSecure pointer
 // class WiFiClientSecure;
@@ -94,11 +95,18 @@ public:
       */
     void process(); // Optional, depending on async approach
 
+    /**
+     * @brief Set a function to run just before rebooting into new firmware
+     * @param callback Saves anything that must survive the reboot; runs on the update task
+     */
+    void setBeforeRestart(std::function<void()> callback) { _beforeRestart = callback; }
+
 private:
     String _currentVersion;
     String _repoOwner;
     String _repoName;
     String _firmwareAssetName = "firmware.bin"; // Default asset name
+    std::function<void()> _beforeRestart; // Run before a successful update reboots
     const char* _githubApiRootCa = \
 "-----BEGIN CERTIFICATE-----\n" \
 "MIICjzCCAhWgAwIBAgIQXIuZxVqUxdJxVt7NiYDMJjAKBggqhkjOPQQDAzCBiDEL\n" \
@@ -8,10 +8,24 @@ SystemController::SystemController() : state{
     WifiState::DISCONNECTED,  // Initial WiFi state
     ApiState::API_NONE,
     AuthState::AUTH_NONE,
-    SystemState::SYS_BOOTING
-} {}
+    SystemState::SYS_BOOTING,
+    0
+}, state_seq(0), write_lock(portMUX_INITIALIZER_UNLOCKED),
+   callbacks_mutex(xSemaphoreCreateMutex()), notifier_task(nullptr), delivered_version(0) {}
 
 void SystemController::begin() {
+    SystemController* controller = getInstance();
+    if (controller->notifier_task == nullptr) {
+        xTaskCreate(
+            notifierTask,
+            "SysStateTask",
+            4096,
+            controller,
+            tskIDLE_PRIORITY + 1,
+            &controller->notifier_task
+        );
+    }
+
     // Register for WiFi state changes
     WiFiInterface::onStateChange(onWiFiStateChange);
     SystemController::setSystemState(SystemState::SYS_BOOTING);
@@ -19,8 +33,7 @@ void SystemController::begin() {
 
 // WiFi event handler
 void SystemController::onWiFiStateChange(WiFiState new_state) {
-    if (getInstance()->state.wifi_state != new_state) {
-        getInstance()->state.wifi_state = new_state;
+    if (getInstance()->write_field(&ControllerState::wifi_state, new_state)) {
         getInstance()->notify_state_change();
     }
 }
@@ -33,57 +46,109 @@ SystemController* SystemController::getInstance() {
     return instance;
 }
 
+// Seqlock read: retry while a write is in progress or lands during the copy
+ControllerState SystemController::read_state() const {
+    for (;;) {
+        uint32_t seq = state_seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue; // Writer on the other core; it can't be preempted, so this is brief
+        }
+        ControllerState copy = state;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (state_seq.load(std::memory_order_relaxed) == seq) {
+            return copy;
+        }
+    }
+}
+
+template <typename T>
+bool SystemController::write_field(T ControllerState::*field, T value) {
+    bool changed = false;
+    portENTER_CRITICAL(&write_lock);
+    if (state.*field != value) {
+        uint32_t seq = state_seq.load(std::memory_order_relaxed);
+        state_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        state.*field = value;
+        state.version++;
+        state_seq.store(seq + 2, std::memory_order_release);
+        changed = true;
+    }
+    portEXIT_CRITICAL(&write_lock);
+    return changed;
+}
+
 // State accessors
 WifiState SystemController::getWifiState() {
-    return getInstance()->state.wifi_state;
+    return getInstance()->read_state().wifi_state;
 }
 
 ApiState SystemController::getApiState() {
-    return getInstance()->state.api_state;
+    return getInstance()->read_state().api_state;
 }
 
 AuthState SystemController::getAuthState() {
-    return getInstance()->state.auth_state;
+    return getInstance()->read_state().auth_state;
 }
 
 SystemState SystemController::getSystemState() {
-    return getInstance()->state.sys_state;
+    return getInstance()->read_state().sys_state;
 }
 
 ControllerState SystemController::getFullState() {
-    return getInstance()->state;
+    return getInstance()->read_state();
 }
 
 // State setters
 void SystemController::setApiState(ApiState new_state) {
-    if (getInstance()->state.api_state != new_state) {
-        getInstance()->state.api_state = new_state;
+    if (getInstance()->write_field(&ControllerState::api_state, new_state)) {
         getInstance()->notify_state_change();
     }
 }
 
 void SystemController::setAuthState(AuthState new_state) {
-    if (getInstance()->state.auth_state != new_state) {
-        getInstance()->state.auth_state = new_state;
+    if (getInstance()->write_field(&ControllerState::auth_state, new_state)) {
         getInstance()->notify_state_change();
     }
 }
 
 void SystemController::setSystemState(SystemState new_state) {
-    if (getInstance()->state.sys_state != new_state) {
-        getInstance()->state.sys_state = new_state;
+    if (getInstance()->write_field(&ControllerState::sys_state, new_state)) {
         getInstance()->notify_state_change();
     }
 }
 
-// Notify state changes and log
 void SystemController::notify_state_change() {
-    auto* controller = getInstance();
+    if (notifier_task != nullptr) {
+        xTaskNotifyGive(notifier_task);
+    } else {
+        deliver_state_change();
+    }
+}
+
+void SystemController::notifierTask(void* param) {
+    SystemController* controller = static_cast<SystemController*>(param);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        controller->deliver_state_change();
+    }
+}
+
+// Log state changes and notify callbacks
+void SystemController::deliver_state_change() {
+    xSemaphoreTake(callbacks_mutex, portMAX_DELAY);
+
+    ControllerState current = read_state();
+    if (current.version == delivered_version) {
+        xSemaphoreGive(callbacks_mutex);
+        return;
+    }
+    delivered_version = current.version;
     
     // Log state changes
     Serial.println("State change:");
     Serial.print("  WiFi: ");
-    switch (controller->state.wifi_state) {
+    switch (current.wifi_state) {
         case WifiState::DISCONNECTED: Serial.println("DISCONNECTED"); break;
         case WifiState::CONNECTING: Serial.println("CONNECTING"); break;
         case WifiState::CONNECTED: Serial.println("CONNECTED"); break;
@@ -91,7 +156,7 @@ void SystemController::notify_state_change() {
     }
     
     Serial.print("  API: ");
-    switch (controller->state.api_state) {
+    switch (current.api_state) {
         case ApiState::API_NONE: Serial.println("NONE"); break;
         case ApiState::API_AWAITING_CONFIG: Serial.println("AWAITING_CONFIG"); break;
         case ApiState::API_CONFIG_INVALID: Serial.println("CONFIG_INVALID"); break;
@@ -99,14 +164,14 @@ void SystemController::notify_state_change() {
     }
     
     Serial.print("  Auth: ");
-    switch (controller->state.auth_state) {
+    switch (current.auth_state) {
         case AuthState::AUTH_NONE: Serial.println("NONE"); break;
         case AuthState::AUTH_AWAITING_LOGIN: Serial.println("AWAITING_LOGIN"); break;
         case AuthState::AUTH_CONFIRMED: Serial.println("CONFIRMED"); break;
     }
     
     Serial.print("  System: ");
-    switch (controller->state.sys_state) {
+    switch (current.sys_state) {
         case SystemState::SYS_BOOTING: Serial.println("BOOTING"); break;
         case SystemState::SYS_READY: Serial.println("READY"); break;
         case SystemState::SYS_IDLE: Serial.println("IDLE"); break;
@@ -114,27 +179,37 @@ void SystemController::notify_state_change() {
     }
     
     // Notify all registered callbacks
-    for (const auto& callback : controller->state_change_callbacks) {
-        callback(controller->state);
+    for (const auto& callback : state_change_callbacks) {
+        callback(current);
     }
+
+    xSemaphoreGive(callbacks_mutex);
 }
 
 // Callback management
 void SystemController::onStateChange(StateChangeCallback callback) {
-    getInstance()->state_change_callbacks.push_back(callback);
+    SystemController* controller = getInstance();
+    xSemaphoreTake(controller->callbacks_mutex, portMAX_DELAY);
+    controller->state_change_callbacks.push_back(callback);
+    xSemaphoreGive(controller->callbacks_mutex);
     // Immediately call the callback with the current state
-    callback(getInstance()->state);
+    callback(controller->read_state());
 }
 
 void SystemController::removeAllCallbacks() {
-    getInstance()->state_change_callbacks.clear();
+    SystemController* controller = getInstance();
+    xSemaphoreTake(controller->callbacks_mutex, portMAX_DELAY);
+    controller->state_change_callbacks.clear();
+    xSemaphoreGive(controller->callbacks_mutex);
 }
 
 // Utility methods
 bool SystemController::isSystemFullyReady() {
-    return getWifiState() == WifiState::CONNECTED &&
-           getApiState() == ApiState::API_CONFIGURED &&
-           (getSystemState() == SystemState::SYS_READY || 
-            getSystemState() == SystemState::SYS_IDLE ||
-            getSystemState() == SystemState::SYS_INSIGHTS_CHANGED);
+    // One snapshot, so the checks can't straddle a change
+    ControllerState current = getInstance()->read_state();
+    return current.wifi_state == WifiState::CONNECTED &&
+           current.api_state == ApiState::API_CONFIGURED &&
+           (current.sys_state == SystemState::SYS_READY || 
+            current.sys_state == SystemState::SYS_IDLE ||
+            current.sys_state == SystemState::SYS_INSIGHTS_CHANGED);
 }
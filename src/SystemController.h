@@ -1,8 +1,12 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
 #include <functional>
 #include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "hardware/WifiInterface.h"
 
 // Use the WiFiInterface's state enum
@@ -49,6 +53,7 @@ struct ControllerState {
     ApiState api_state;      ///< Current API configuration state
     AuthState auth_state;    ///< Current authentication state
     SystemState sys_state;   ///< Current system state
+    uint32_t version;        ///< Bumped on every change, so readers can tell snapshots apart
 };
 
 /**
@@ -56,7 +61,9 @@ struct ControllerState {
  * @brief Function type for state change notifications
  * 
  * Callbacks are invoked immediately upon registration with current state,
- * and subsequently whenever any state component changes.
+ * and subsequently, from the notifier task, after state components change.
+ * Changes made in quick succession may arrive as one notification carrying
+ * the latest state.
  */
 typedef std::function<void(const ControllerState&)> StateChangeCallback;
 
@@ -68,13 +75,21 @@ typedef std::function<void(const ControllerState&)> StateChangeCallback;
  * API configuration, authentication, and system readiness. Provides a 
  * callback mechanism for state change notifications.
  * 
- * State changes are logged to Serial for debugging purposes.
+ * State is published with a seqlock: getters on any task or core copy a
+ * consistent snapshot without taking a lock, retrying only if a write
+ * landed mid-copy. Setters never run callbacks themselves; they wake a
+ * notifier task that logs the new state and calls the callbacks.
  */
 class SystemController {
 private:
-    ControllerState state;
+    ControllerState state;                 ///< Written only inside write_lock
+    std::atomic<uint32_t> state_seq;       ///< Odd while state is being written
+    portMUX_TYPE write_lock;               ///< Serializes writers; also keeps them from being preempted mid-write
     static SystemController* instance;
     std::vector<StateChangeCallback> state_change_callbacks;
+    SemaphoreHandle_t callbacks_mutex;     ///< Guards state_change_callbacks
+    TaskHandle_t notifier_task;            ///< Delivers notifications, null before begin()
+    uint32_t delivered_version;            ///< Last version handed to callbacks (notifier only)
     
     /**
      * @brief Private constructor for singleton pattern
@@ -92,12 +107,36 @@ private:
     void operator=(const SystemController&) = delete;
     
     /**
-     * @brief Notify all registered callbacks of state change
+     * @brief Copy a consistent snapshot of the state
+     */
+    ControllerState read_state() const;
+
+    /**
+     * @brief Change one state component
+     * @return true if the value differed and was published
+     */
+    template <typename T>
+    bool write_field(T ControllerState::*field, T value);
+
+    /**
+     * @brief Wake the notifier task after a state change
      * 
-     * Logs current state to Serial and calls all registered callbacks
-     * with the current state. Only called when a state component actually changes.
+     * Falls back to delivering on the calling task if the notifier isn't running.
      */
     void notify_state_change();
+
+    /**
+     * @brief Log the current state and call all registered callbacks with it
+     * 
+     * Skips delivery if the state hasn't changed since the last delivery.
+     */
+    void deliver_state_change();
+
+    /**
+     * @brief Notifier task body
+     * @param param The SystemController instance
+     */
+    static void notifierTask(void* param);
     
     /**
      * @brief Get singleton instance
@@ -117,7 +156,8 @@ public:
     /**
      * @brief Initialize the system controller
      * 
-     * Registers for WiFi state changes and sets initial system state to BOOTING
+     * Starts the notifier task, registers for WiFi state changes and sets
+     * initial system state to BOOTING
      */
     static void begin();
     
@@ -147,7 +187,7 @@ public:
 
     /**
      * @brief Get complete system state
-     * @return Structure containing all state components
+     * @return Consistent snapshot of all state components
      */
     static ControllerState getFullState();
     
@@ -180,7 +220,7 @@ public:
      * @param callback Function to call on state change
      * 
      * Callback is immediately invoked with current state upon registration,
-     * and subsequently whenever any state component changes
+     * and subsequently from the notifier task whenever any state component changes
      */
     static void onStateChange(StateChangeCallback callback);
 
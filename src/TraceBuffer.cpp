@@ -0,0 +1,224 @@
+#include "TraceBuffer.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <new>
+
+std::atomic<TraceBuffer::Slot*> TraceBuffer::_slots(nullptr);
+size_t TraceBuffer::_capacity = 0;
+std::atomic<uint32_t> TraceBuffer::_nextIndex(0);
+std::atomic<uint32_t> TraceBuffer::_nextAsyncId(1);
+
+namespace {
+
+// Export document stages
+enum : uint8_t {
+    STAGE_HEADER,
+    STAGE_RECORDS,
+    STAGE_THREADS,
+    STAGE_FOOTER,
+    STAGE_DONE
+};
+
+// Task names land inside JSON strings; keep them printable and quote-free
+void sanitizeTaskName(char* name) {
+    for (char* c = name; *c; c++) {
+        if (*c == '"' || *c == '\\' || *c < 0x20) {
+            *c = '_';
+        }
+    }
+}
+
+}
+
+void TraceBuffer::begin(size_t capacity) {
+    if (_slots.load() != nullptr) {
+        return;
+    }
+
+    // Power of two so a claim index maps to a slot with a mask
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    void* memory = heap_caps_malloc(size * sizeof(Slot), MALLOC_CAP_SPIRAM);
+    if (memory == nullptr) {
+        memory = heap_caps_malloc(size * sizeof(Slot), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (memory == nullptr) {
+        Serial.println("[TraceBuffer] Failed to allocate trace ring, tracing disabled");
+        return;
+    }
+
+    Slot* slots = static_cast<Slot*>(memory);
+    for (size_t i = 0; i < size; i++) {
+        new (&slots[i]) Slot();
+        slots[i].seq.store(0, std::memory_order_relaxed);
+    }
+
+    _capacity = size;
+    _slots.store(slots, std::memory_order_release);
+    Serial.printf("[TraceBuffer] Recording up to %u trace records\n", (unsigned)size);
+}
+
+void TraceBuffer::record(char phase, const char* name, uint32_t id, uint32_t arg) {
+    Slot* slots = _slots.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+        return;
+    }
+
+    uint32_t index = _nextIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & (_capacity - 1)];
+
+    // Zero marks the slot torn until the record is complete
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    Record& record = slot.record;
+    record.timestampUs = esp_timer_get_time();
+    record.name = name;
+    record.taskId = (uint32_t)(uintptr_t)task;
+    record.id = id;
+    record.arg = arg;
+    strncpy(record.task, pcTaskGetName(task), sizeof(record.task) - 1);
+    record.task[sizeof(record.task) - 1] = '\0';
+    record.core = (uint8_t)xPortGetCoreID();
+    record.phase = phase;
+
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+uint32_t TraceBuffer::nextAsyncId() {
+    uint32_t id = _nextAsyncId.fetch_add(1, std::memory_order_relaxed);
+    return id != 0 ? id : _nextAsyncId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TraceBuffer::snapshot(std::vector<Record>& out) {
+    out.clear();
+
+    Slot* slots = _slots.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+        return;
+    }
+
+    uint32_t end = _nextIndex.load(std::memory_order_acquire);
+    uint32_t start = end > _capacity ? end - (uint32_t)_capacity : 0;
+    out.reserve(end - start);
+
+    for (uint32_t index = start; index != end; index++) {
+        const Slot& slot = slots[index & (_capacity - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+            continue; // Still being written, or already overwritten
+        }
+
+        Record copy = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != index + 1) {
+            continue; // Overwritten while we copied
+        }
+        out.push_back(copy);
+    }
+}
+
+TraceBuffer::ChromeExport::ChromeExport()
+    : _next(0)
+    , _nextThread(0)
+    , _stage(STAGE_HEADER)
+    , _pendingOffset(0) {
+    TraceBuffer::snapshot(_records);
+
+    // Name each task once, from its first record
+    for (size_t i = 0; i < _records.size(); i++) {
+        bool seen = false;
+        for (size_t thread : _threads) {
+            if (_records[thread].taskId == _records[i].taskId) {
+                seen = true;
+                break;
+            }
+        }
+        if (!seen) {
+            _threads.push_back(i);
+        }
+    }
+}
+
+size_t TraceBuffer::ChromeExport::read(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (_pendingOffset >= _pending.length()) {
+            _pending = "";
+            _pendingOffset = 0;
+            if (!produce()) {
+                break;
+            }
+        }
+
+        size_t count = std::min(maxLen - written, _pending.length() - _pendingOffset);
+        memcpy(buffer + written, _pending.c_str() + _pendingOffset, count);
+        _pendingOffset += count;
+        written += count;
+    }
+    return written;
+}
+
+bool TraceBuffer::ChromeExport::produce() {
+    char line[256];
+
+    switch (_stage) {
+        case STAGE_HEADER:
+            _pending = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            _stage = STAGE_RECORDS;
+            return true;
+
+        case STAGE_RECORDS: {
+            if (_next >= _records.size()) {
+                _stage = STAGE_THREADS;
+                return produce();
+            }
+
+            const Record& record = _records[_next];
+            int length = snprintf(line, sizeof(line),
+                "%s{\"name\":\"%s\",\"cat\":\"posthog\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%u",
+                _next == 0 ? "" : ",", record.name, record.phase,
+                (unsigned long long)record.timestampUs, (unsigned)record.taskId);
+            if (record.phase == 'b' || record.phase == 'n' || record.phase == 'e') {
+                length += snprintf(line + length, sizeof(line) - length, ",\"id\":%u", (unsigned)record.id);
+            } else if (record.phase == 'i') {
+                length += snprintf(line + length, sizeof(line) - length, ",\"s\":\"t\"");
+            }
+            snprintf(line + length, sizeof(line) - length, ",\"args\":{\"arg\":%u,\"core\":%u}}",
+                     (unsigned)record.arg, (unsigned)record.core);
+
+            _pending = line;
+            _next++;
+            return true;
+        }
+
+        case STAGE_THREADS: {
+            if (_nextThread >= _threads.size()) {
+                _stage = STAGE_FOOTER;
+                return produce();
+            }
+
+            const Record& record = _records[_threads[_nextThread++]];
+            char name[sizeof(record.task)];
+            memcpy(name, record.task, sizeof(name));
+            sanitizeTaskName(name);
+            snprintf(line, sizeof(line),
+                ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                (unsigned)record.taskId, name);
+            _pending = line;
+            return true;
+        }
+
+        case STAGE_FOOTER:
+            _pending = "]}";
+            _stage = STAGE_DONE;
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @class TraceBuffer
+ * @brief Fixed-size, lock-free ring of timing records for offline analysis
+ *
+ * Any task may record; writers claim a slot with a single atomic increment
+ * and never block, so tracing is cheap enough to leave on in release
+ * builds. Once the ring is full the oldest records are overwritten.
+ *
+ * Record names must be string literals (only the pointer is stored).
+ * The ring exports as Chrome trace_event JSON, which opens directly in
+ * Perfetto or chrome://tracing:
+ * - spanBegin()/spanEnd() and Span mark synchronous work on the calling task
+ * - asyncBegin()/asyncStep()/asyncEnd() follow work that hops between
+ *   calls or tasks, such as an HTTP request, by a shared ID
+ * - instant() marks a point in time
+ *
+ * Nothing is recorded until begin() has allocated the ring.
+ */
+class TraceBuffer {
+public:
+    /**
+     * @struct Record
+     * @brief One traced moment
+     */
+    struct Record {
+        uint64_t timestampUs;   ///< esp_timer time of the record
+        const char* name;       ///< Event or span name, a string literal
+        uint32_t taskId;        ///< Recording task's handle, used as the trace thread ID
+        uint32_t id;            ///< Async span ID, 0 for synchronous records
+        uint32_t arg;           ///< Free-form argument (event type, byte count, ...)
+        char task[12];          ///< Recording task's name, truncated
+        uint8_t core;           ///< Core the record was made on
+        char phase;             ///< Chrome trace phase: B, E, i, b, n or e
+    };
+
+    /**
+     * @class Span
+     * @brief Records begin on construction and end on destruction
+     */
+    class Span {
+    public:
+        explicit Span(const char* name, uint32_t arg = 0) : _name(name) { TraceBuffer::spanBegin(name, arg); }
+        ~Span() { TraceBuffer::spanEnd(_name); }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* _name;
+    };
+
+    /**
+     * @class ChromeExport
+     * @brief Incremental Chrome trace_event JSON writer over a ring snapshot
+     *
+     * Takes its snapshot on construction, so the ring can keep recording
+     * while a slow client downloads the export.
+     */
+    class ChromeExport {
+    public:
+        ChromeExport();
+
+        /**
+         * @brief Fill a buffer with the next part of the JSON document
+         * @param buffer Output buffer
+         * @param maxLen Size of the buffer
+         * @return Bytes written, 0 once the document is complete
+         */
+        size_t read(uint8_t* buffer, size_t maxLen);
+
+    private:
+        /**
+         * @brief Format the next piece of the document into _pending
+         * @return false when nothing is left
+         */
+        bool produce();
+
+        std::vector<Record> _records;   ///< Snapshot, oldest first
+        std::vector<size_t> _threads;   ///< First record of each task
+        size_t _next;                   ///< Next record to format
+        size_t _nextThread;             ///< Next entry of _threads to name
+        uint8_t _stage;                 ///< Header, records, thread names, footer, done
+        String _pending;                ///< Formatted text not yet handed out
+        size_t _pendingOffset;          ///< How much of _pending was handed out
+    };
+
+    /**
+     * @brief Allocate the ring, preferring PSRAM
+     * @param capacity Number of records, rounded up to a power of two
+     */
+    static void begin(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Record one moment
+     * @param phase Chrome trace phase
+     * @param name String literal naming the event
+     * @param id Async span ID, 0 for synchronous records
+     * @param arg Free-form argument
+     */
+    static void record(char phase, const char* name, uint32_t id = 0, uint32_t arg = 0);
+
+    static void spanBegin(const char* name, uint32_t arg = 0) { record('B', name, 0, arg); }
+    static void spanEnd(const char* name, uint32_t arg = 0) { record('E', name, 0, arg); }
+    static void instant(const char* name, uint32_t arg = 0) { record('i', name, 0, arg); }
+    static void asyncBegin(const char* name, uint32_t id, uint32_t arg = 0) { record('b', name, id, arg); }
+    static void asyncStep(const char* name, uint32_t id, uint32_t arg = 0) { record('n', name, id, arg); }
+    static void asyncEnd(const char* name, uint32_t id, uint32_t arg = 0) { record('e', name, id, arg); }
+
+    /**
+     * @brief Get an ID for a new async span
+     * @return Non-zero ID, unique until it wraps
+     */
+    static uint32_t nextAsyncId();
+
+    /**
+     * @brief Copy every complete record out of the ring
+     * @param out Filled with records, oldest first
+     *
+     * Records being written during the copy are skipped.
+     */
+    static void snapshot(std::vector<Record>& out);
+
+    /**
+     * @brief Get the ring size
+     * @return Number of records kept, 0 before begin()
+     */
+    static size_t capacity() { return _capacity; }
+
+    static constexpr size_t DEFAULT_CAPACITY = 1024;   ///< About 48KB of PSRAM
+
+private:
+    /**
+     * @struct Slot
+     * @brief A record plus the sequence number guarding it
+     */
+    struct Slot {
+        std::atomic<uint32_t> seq;   ///< Claim index + 1 once written, 0 while being written
+        Record record;
+    };
+
+    static std::atomic<Slot*> _slots;
+    static size_t _capacity;
+    static std::atomic<uint32_t> _nextIndex;
+    static std::atomic<uint32_t> _nextAsyncId;
+};
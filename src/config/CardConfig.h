@@ -10,7 +10,8 @@
 enum class CardType {
     INSIGHT,      ///< PostHog insight visualization card
     FRIEND,       ///< Walking animation/encouragement card
-    HELLO_WORLD   ///< Simple hello world card
+    HELLO_WORLD,  ///< Simple hello world card
+    PERFORMANCE   ///< Render, CPU, memory and queue stats
     // New card types can be added here
 };
 
@@ -79,6 +80,7 @@ inline String cardTypeToString(CardType type) {
         case CardType::INSIGHT: return "INSIGHT";
         case CardType::FRIEND: return "FRIEND";
         case CardType::HELLO_WORLD: return "HELLO_WORLD";
+        case CardType::PERFORMANCE: return "PERFORMANCE";
         default: return "UNKNOWN";
     }
 }
@@ -92,5 +94,6 @@ inline CardType stringToCardType(const String& str) {
     if (str == "INSIGHT") return CardType::INSIGHT;
     if (str == "FRIEND") return CardType::FRIEND;
     if (str == "HELLO_WORLD") return CardType::HELLO_WORLD;
+    if (str == "PERFORMANCE") return CardType::PERFORMANCE;
     return CardType::INSIGHT; // Default fallback
 }
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "config/CardConfigStore.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+
+CardConfigStore::CardConfigStore()
+    : _indexDirty(false)
+    , _mutex(xSemaphoreCreateMutex())
+    , _commitTask(nullptr) {
+}
+
+CardConfigStore::~CardConfigStore() {
+    if (_commitTask != nullptr) {
+        vTaskDelete(_commitTask);
+    }
+    flush();
+    _prefs.end();
+    if (_mutex != nullptr) {
+        vSemaphoreDelete(_mutex);
+    }
+}
+
+void CardConfigStore::begin(const char* nameSpace) {
+    _prefs.begin(nameSpace, false);
+
+    unsigned long start = millis();
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    load();
+    xSemaphoreGive(_mutex);
+    Serial.printf("[CardConfigStore] Loaded %u cards in %lu ms\n", (unsigned)_entries.size(), millis() - start);
+
+    if (_commitTask == nullptr) {
+        xTaskCreate(
+            commitTask,
+            "CardStoreTask",
+            4096,
+            this,
+            tskIDLE_PRIORITY + 1,
+            &_commitTask
+        );
+    }
+}
+
+std::vector<CardConfig> CardConfigStore::getAll() const {
+    std::vector<CardConfig> configs;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    configs.reserve(_entries.size());
+    for (const Entry& entry : _entries) {
+        configs.push_back(entry.config);
+    }
+    xSemaphoreGive(_mutex);
+
+    return configs;
+}
+
+bool CardConfigStore::save(const std::vector<CardConfig>& configs) {
+    if (configs.size() > MAX_CARDS) {
+        Serial.printf("[CardConfigStore] Refusing to save %u cards, limit is %u\n",
+                      (unsigned)configs.size(), (unsigned)MAX_CARDS);
+        return false;
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    std::vector<Entry> previous = std::move(_entries);
+    std::vector<bool> reused(previous.size(), false);
+    _entries.clear();
+    _entries.reserve(configs.size());
+
+    for (const CardConfig& config : configs) {
+        // Keep the record of the same card, so unchanged cards aren't rewritten
+        size_t match = previous.size();
+        for (size_t i = 0; i < previous.size(); i++) {
+            if (!reused[i] && previous[i].config.type == config.type &&
+                previous[i].config.config == config.config) {
+                match = i;
+                break;
+            }
+        }
+
+        if (match < previous.size()) {
+            reused[match] = true;
+            Entry& old = previous[match];
+            bool changed = old.config.order != config.order || old.config.name != config.name;
+            _entries.push_back(Entry{config, old.recordId, old.dirty || changed});
+        } else {
+            _entries.push_back(Entry{config, allocateRecordId(previous), true});
+        }
+    }
+
+    for (size_t i = 0; i < previous.size(); i++) {
+        if (!reused[i]) {
+            _removed.push_back(previous[i].recordId);
+        }
+    }
+
+    bool sameOrder = previous.size() == _entries.size();
+    for (size_t i = 0; sameOrder && i < _entries.size(); i++) {
+        sameOrder = previous[i].recordId == _entries[i].recordId;
+    }
+    _indexDirty = _indexDirty || !sameOrder;
+
+    xSemaphoreGive(_mutex);
+
+    if (_commitTask != nullptr) {
+        xTaskNotifyGive(_commitTask);
+    } else {
+        flush();
+    }
+    return true;
+}
+
+void CardConfigStore::flush() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    flushLocked();
+    xSemaphoreGive(_mutex);
+}
+
+bool CardConfigStore::flushLocked() {
+    char key[16];
+    size_t written = 0;
+    std::vector<uint8_t> buffer;
+
+    for (Entry& entry : _entries) {
+        if (!entry.dirty) {
+            continue;
+        }
+
+        const CardConfig& config = entry.config;
+        String typeName = cardTypeToString(config.type);
+        RecordHeader header = {};
+        header.version = FORMAT_VERSION;
+        header.typeLength = typeName.length();
+        header.configLength = config.config.length();
+        header.nameLength = config.name.length();
+        header.order = config.order;
+
+        buffer.resize(sizeof(header) + header.typeLength + header.configLength + header.nameLength);
+        uint8_t* out = buffer.data();
+        memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        memcpy(out, typeName.c_str(), header.typeLength);
+        out += header.typeLength;
+        memcpy(out, config.config.c_str(), header.configLength);
+        out += header.configLength;
+        memcpy(out, config.name.c_str(), header.nameLength);
+
+        recordKey(entry.recordId, key, sizeof(key));
+        if (_prefs.putBytes(key, buffer.data(), buffer.size()) != buffer.size()) {
+            Serial.printf("[CardConfigStore] Failed to write %s\n", key);
+            return false;
+        }
+        entry.dirty = false;
+        written++;
+    }
+
+    if (_indexDirty) {
+        DeckHeader header = {};
+        header.version = FORMAT_VERSION;
+        header.count = _entries.size();
+
+        buffer.resize(sizeof(header) + _entries.size() * sizeof(uint16_t));
+        memcpy(buffer.data(), &header, sizeof(header));
+        for (size_t i = 0; i < _entries.size(); i++) {
+            memcpy(buffer.data() + sizeof(header) + i * sizeof(uint16_t), &_entries[i].recordId, sizeof(uint16_t));
+        }
+
+        if (_prefs.putBytes(INDEX_KEY, buffer.data(), buffer.size()) != buffer.size()) {
+            Serial.println("[CardConfigStore] Failed to write deck index");
+            return false;
+        }
+        _indexDirty = false;
+    }
+
+    // Only now is nothing pointing at the removed records
+    for (uint16_t recordId : _removed) {
+        recordKey(recordId, key, sizeof(key));
+        _prefs.remove(key);
+    }
+
+    if (written > 0 || !_removed.empty()) {
+        Serial.printf("[CardConfigStore] Committed %u records, removed %u\n",
+                      (unsigned)written, (unsigned)_removed.size());
+    }
+    _removed.clear();
+    return true;
+}
+
+void CardConfigStore::load() {
+    _entries.clear();
+    _removed.clear();
+    _indexDirty = false;
+
+    if (!_prefs.isKey(INDEX_KEY)) {
+        if (migrateFromJson() && flushLocked()) {
+            _prefs.remove(LEGACY_JSON_KEY);
+            Serial.printf("[CardConfigStore] Migrated %u cards from JSON\n", (unsigned)_entries.size());
+        }
+        return;
+    }
+
+    size_t indexLength = _prefs.getBytesLength(INDEX_KEY);
+    if (indexLength < sizeof(DeckHeader)) {
+        Serial.println("[CardConfigStore] Deck index is truncated, starting empty");
+        return;
+    }
+
+    std::vector<uint8_t> index(indexLength);
+    _prefs.getBytes(INDEX_KEY, index.data(), index.size());
+    DeckHeader deck;
+    memcpy(&deck, index.data(), sizeof(deck));
+    if (deck.version != FORMAT_VERSION || indexLength < sizeof(deck) + deck.count * sizeof(uint16_t)) {
+        Serial.printf("[CardConfigStore] Unsupported deck index (version %u), starting empty\n", deck.version);
+        return;
+    }
+
+    char key[16];
+    std::vector<uint8_t> record;
+    _entries.reserve(deck.count);
+
+    for (size_t i = 0; i < deck.count; i++) {
+        uint16_t recordId;
+        memcpy(&recordId, index.data() + sizeof(deck) + i * sizeof(uint16_t), sizeof(recordId));
+
+        recordKey(recordId, key, sizeof(key));
+        size_t length = _prefs.getBytesLength(key);
+        if (length < sizeof(RecordHeader)) {
+            Serial.printf("[CardConfigStore] Record %s missing, skipping\n", key);
+            _indexDirty = true;
+            continue;
+        }
+
+        record.resize(length);
+        _prefs.getBytes(key, record.data(), record.size());
+        RecordHeader header;
+        memcpy(&header, record.data(), sizeof(header));
+        if (header.version != FORMAT_VERSION ||
+            length < sizeof(header) + header.typeLength + header.configLength + header.nameLength) {
+            Serial.printf("[CardConfigStore] Record %s unreadable, skipping\n", key);
+            _removed.push_back(recordId);
+            _indexDirty = true;
+            continue;
+        }
+
+        const char* in = reinterpret_cast<const char*>(record.data() + sizeof(header));
+        String typeName;
+        typeName.concat(in, header.typeLength);
+        in += header.typeLength;
+
+        // stringToCardType() falls back to INSIGHT; a type this firmware doesn't know is dropped instead
+        Entry entry{CardConfig(), recordId, false};
+        entry.config.type = stringToCardType(typeName);
+        if (cardTypeToString(entry.config.type) != typeName) {
+            Serial.printf("[CardConfigStore] Record %s has unknown card type %s, skipping\n", key, typeName.c_str());
+            _removed.push_back(recordId);
+            _indexDirty = true;
+            continue;
+        }
+
+        entry.config.order = header.order;
+        entry.config.config.concat(in, header.configLength);
+        in += header.configLength;
+        entry.config.name.concat(in, header.nameLength);
+        _entries.push_back(entry);
+    }
+}
+
+bool CardConfigStore::migrateFromJson() {
+    if (!_prefs.isKey(LEGACY_JSON_KEY)) {
+        return false;
+    }
+
+    String jsonString = _prefs.getString(LEGACY_JSON_KEY, "[]");
+
+    // The JSON format never held more than a 2KB document
+    DynamicJsonDocument doc(2048);
+    DeserializationError error = deserializeJson(doc, jsonString);
+    if (error) {
+        Serial.printf("[CardConfigStore] Failed to parse legacy card configs JSON: %s\n", error.c_str());
+        return false;
+    }
+
+    JsonArray array = doc.as<JsonArray>();
+    for (JsonVariant v : array) {
+        JsonObject obj = v.as<JsonObject>();
+        if (obj.containsKey("type") && obj.containsKey("config") && obj.containsKey("order")) {
+            CardConfig config;
+            config.type = stringToCardType(obj["type"].as<String>());
+            config.config = obj["config"].as<String>();
+            config.order = obj["order"].as<int>();
+            config.name = obj["name"].as<String>();
+            _entries.push_back(Entry{config, (uint16_t)_entries.size(), true});
+        }
+    }
+
+    _indexDirty = true;
+    return true;
+}
+
+uint16_t CardConfigStore::allocateRecordId(const std::vector<Entry>& previous) const {
+    std::vector<uint16_t> used;
+    used.reserve(_entries.size() + previous.size() + _removed.size());
+    for (const Entry& entry : _entries) {
+        used.push_back(entry.recordId);
+    }
+    for (const Entry& entry : previous) {
+        used.push_back(entry.recordId);
+    }
+    used.insert(used.end(), _removed.begin(), _removed.end());
+    std::sort(used.begin(), used.end());
+
+    uint16_t candidate = 0;
+    for (uint16_t id : used) {
+        if (id == candidate) {
+            candidate++;
+        } else if (id > candidate) {
+            break;
+        }
+    }
+    return candidate;
+}
+
+void CardConfigStore::recordKey(uint16_t recordId, char* key, size_t size) {
+    snprintf(key, size, "c%u", (unsigned)recordId);
+}
+
+void CardConfigStore::commitTask(void* param) {
+    CardConfigStore* store = static_cast<CardConfigStore*>(param);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Wait for the edits to settle so a burst is written once
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(COMMIT_DELAY_MS)) > 0) {
+        }
+
+        store->flush();
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "config/CardConfig.h"
+
+/**
+ * @class CardConfigStore
+ * @brief Binary, per-card NVS storage for the card deck
+ *
+ * Each card is its own small NVS blob: a fixed RecordHeader followed by the
+ * card type's name, config and name bytes. Types are stored by name, so
+ * reordering CardType never changes what a stored card loads as. A deck
+ * index blob lists the cards' record IDs in order. Saving the deck compares
+ * it with the cached copy and rewrites only new or changed records, so
+ * renaming one card touches one record.
+ *
+ * Reads are served from RAM. Writes update RAM immediately and reach flash
+ * once the deck has been quiet for COMMIT_DELAY_MS, so a burst of portal
+ * edits costs one set of flash writes.
+ *
+ * On first boot after upgrading, the deck is migrated from the old JSON blob.
+ */
+class CardConfigStore {
+public:
+    static constexpr uint8_t FORMAT_VERSION = 1;        ///< Bumped when the record layout changes
+    static constexpr size_t MAX_CARDS = 128;            ///< Largest deck accepted
+    static constexpr uint32_t COMMIT_DELAY_MS = 2000;   ///< Quiet time before edits are written
+
+    CardConfigStore();
+    ~CardConfigStore();
+
+    CardConfigStore(const CardConfigStore&) = delete;
+    CardConfigStore& operator=(const CardConfigStore&) = delete;
+
+    /**
+     * @brief Open storage, load the deck and start the commit task
+     * @param nameSpace NVS namespace holding the deck
+     */
+    void begin(const char* nameSpace);
+
+    /**
+     * @brief Get the deck
+     * @return Copy of the cached card configurations, in stored order
+     */
+    std::vector<CardConfig> getAll() const;
+
+    /**
+     * @brief Replace the deck
+     * @param configs New card configurations
+     * @return false if the deck is too large to store
+     *
+     * Takes effect in RAM immediately; the flash write follows after
+     * COMMIT_DELAY_MS without further changes.
+     */
+    bool save(const std::vector<CardConfig>& configs);
+
+    /**
+     * @brief Write pending changes to flash now
+     */
+    void flush();
+
+private:
+    /**
+     * @struct RecordHeader
+     * @brief Fixed part of a stored card, followed by type name, config then name bytes
+     */
+    struct RecordHeader {
+        uint8_t version;         ///< FORMAT_VERSION the record was written with
+        uint8_t typeLength;      ///< Bytes of cardTypeToString() name after the header
+        uint16_t configLength;   ///< Bytes of config after the type name
+        uint16_t nameLength;     ///< Bytes of name after the config
+        uint16_t reserved;
+        int32_t order;           ///< Display order
+    };
+    static_assert(sizeof(RecordHeader) == 12, "RecordHeader layout is stored in flash");
+
+    /**
+     * @struct DeckHeader
+     * @brief Start of the deck index, followed by one uint16_t record ID per card
+     */
+    struct DeckHeader {
+        uint8_t version;         ///< FORMAT_VERSION the index was written with
+        uint8_t reserved;
+        uint16_t count;          ///< Number of record IDs that follow
+    };
+    static_assert(sizeof(DeckHeader) == 4, "DeckHeader layout is stored in flash");
+
+    /**
+     * @struct Entry
+     * @brief Cached card plus where and whether it needs storing
+     */
+    struct Entry {
+        CardConfig config;
+        uint16_t recordId;       ///< Suffix of the record's NVS key
+        bool dirty;              ///< Record differs from flash
+    };
+
+    /**
+     * @brief Load the binary deck, or migrate the JSON blob (caller holds _mutex)
+     */
+    void load();
+
+    /**
+     * @brief Read the deck from the pre-binary JSON blob
+     * @return true if a JSON blob was found and parsed
+     */
+    bool migrateFromJson();
+
+    /**
+     * @brief Write dirty records, the index and deletions (caller holds _mutex)
+     * @return true if everything was written
+     */
+    bool flushLocked();
+
+    /**
+     * @brief Pick a record ID not used by the deck, the deck being replaced or pending deletion
+     * @param previous Deck being replaced by save()
+     */
+    uint16_t allocateRecordId(const std::vector<Entry>& previous) const;
+
+    /**
+     * @brief Format a record's NVS key
+     */
+    static void recordKey(uint16_t recordId, char* key, size_t size);
+
+    /**
+     * @brief Commit task body: waits for edits, then for quiet, then flushes
+     * @param param The CardConfigStore instance
+     */
+    static void commitTask(void* param);
+
+    Preferences _prefs;
+    std::vector<Entry> _entries;           ///< Cached deck in order
+    std::vector<uint16_t> _removed;        ///< Records to delete once the index no longer lists them
+    bool _indexDirty;                      ///< Deck index differs from flash
+    SemaphoreHandle_t _mutex;              ///< Guards everything above
+    TaskHandle_t _commitTask;              ///< Debounces flushes, null before begin()
+
+    static constexpr const char* INDEX_KEY = "deck";            ///< NVS key of the deck index
+    static constexpr const char* LEGACY_JSON_KEY = "config_list"; ///< NVS key of the old JSON blob
+};
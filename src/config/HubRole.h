@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Role this device plays in sharing insight data over the LAN
+ */
+enum class HubRole {
+    STANDALONE,   ///< Fetches its own insights, no LAN sharing
+    HUB,          ///< Fetches insights and multicasts snapshots to followers
+    FOLLOWER      ///< Never talks to PostHog, renders snapshots from the hub
+};
+
+/**
+ * @brief Helper function to convert HubRole enum to string
+ * @param role The HubRole to convert
+ * @return String representation of the role
+ */
+inline String hubRoleToString(HubRole role) {
+    switch (role) {
+        case HubRole::STANDALONE: return "STANDALONE";
+        case HubRole::HUB: return "HUB";
+        case HubRole::FOLLOWER: return "FOLLOWER";
+        default: return "STANDALONE";
+    }
+}
+
+/**
+ * @brief Helper function to convert string to HubRole enum
+ * @param str The string to convert
+ * @return HubRole enum value, defaults to STANDALONE if string not recognized
+ */
+inline HubRole stringToHubRole(const String& str) {
+    if (str == "HUB") return HubRole::HUB;
+    if (str == "FOLLOWER") return HubRole::FOLLOWER;
+    return HubRole::STANDALONE; // Default fallback
+}
@@ -1,4 +1,8 @@
 #include "DisplayInterface.h"
+#include "ST7789Panel.h"
+#include "../TraceBuffer.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 // A pointer to the instance for use in static callbacks
 static DisplayInterface* instance = nullptr;
@@ -14,39 +18,37 @@ DisplayInterface::DisplayInterface(
 ) : _screen_width(screen_width),
     _screen_height(screen_height),
     _buffer_rows(buffer_rows),
+    _buffer_bytes((size_t)screen_width * buffer_rows * lv_color_format_get_size(LV_COLOR_FORMAT_RGB565)),
     _cs_pin(cs_pin),
     _dc_pin(dc_pin),
     _rst_pin(rst_pin),
     _backlight_pin(backlight_pin),
-    _tft(nullptr),
+    _panel(nullptr),
     _display(nullptr),
     _buf1(nullptr),
     _buf2(nullptr),
-    _lvgl_mutex(nullptr) {
+    _lvgl_mutex(nullptr),
+    _lvgl_task(nullptr) {
     
     // Store instance for static callbacks
     instance = this;
     
-    // Create TFT object
-    _tft = new Adafruit_ST7789(&SPI, _cs_pin, _dc_pin, _rst_pin);
-    if (!_tft) {
-        Serial.println("Failed to create TFT object");
-        return;
-    }
+    // Create panel; a buffer is the largest window it will be asked to send
+    _panel = new ST7789Panel(_screen_width, _screen_height, _cs_pin, _dc_pin, _rst_pin, _buffer_bytes);
     
-    // Allocate display buffers using C++ new operator instead of malloc
-    try {
-        _buf1 = new lv_color_t[_screen_width * _buffer_rows];
-        _buf2 = new lv_color_t[_screen_width * _buffer_rows];
-    } catch (std::bad_alloc&) {
+    // Display buffers are sent by DMA straight from where LVGL renders them,
+    // so they must be internal RAM; keep them to a band of the screen
+    _buf1 = static_cast<uint8_t*>(heap_caps_malloc(_buffer_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+    _buf2 = static_cast<uint8_t*>(heap_caps_malloc(_buffer_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+    if (!_buf1 || !_buf2) {
         Serial.println("Failed to allocate display buffers");
         // Clean up already allocated resources
-        delete _tft;
-        _tft = nullptr;
-        if (_buf1) {
-            delete[] _buf1;
-            _buf1 = nullptr;
-        }
+        delete _panel;
+        _panel = nullptr;
+        heap_caps_free(_buf1);
+        _buf1 = nullptr;
+        heap_caps_free(_buf2);
+        _buf2 = nullptr;
         return;
     }
     
@@ -55,11 +57,11 @@ DisplayInterface::DisplayInterface(
     if (_lvgl_mutex == nullptr) {
         Serial.println("Could not create mutex");
         // Clean up already allocated resources
-        delete _tft;
-        _tft = nullptr;
-        delete[] _buf1;
+        delete _panel;
+        _panel = nullptr;
+        heap_caps_free(_buf1);
         _buf1 = nullptr;
-        delete[] _buf2;
+        heap_caps_free(_buf2);
         _buf2 = nullptr;
         return;
     }
@@ -67,25 +69,24 @@ DisplayInterface::DisplayInterface(
 
 void DisplayInterface::begin() {
     // Check if initialization failed
-    if (!_tft || !_buf1 || !_buf2 || !_lvgl_mutex) {
+    if (!_panel || !_buf1 || !_buf2 || !_lvgl_mutex) {
         Serial.println("Cannot initialize display: resources not allocated");
         return;
     }
     
-    // Initialize SPI
-    SPI.begin();
-    
     // Initialize display
-    _tft->init(_screen_height, _screen_width);
-    _tft->setRotation(1);
+    if (!_panel->begin()) {
+        Serial.println("Failed to initialize display panel");
+        return;
+    }
     
     // Configure backlight
     pinMode(_backlight_pin, OUTPUT);
     digitalWrite(_backlight_pin, HIGH);
-    _tft->fillScreen(ST77XX_BLACK);
     
     // Initialize LVGL
     lv_init();
+    lv_tick_set_cb(_tick_ms);
     
     // Initialize and register display for LVGL v9
     _display = lv_display_create(_screen_width, _screen_height);
@@ -94,14 +95,18 @@ void DisplayInterface::begin() {
         return;
     }
     
+    // Render high byte first, as the panel reads it, so flushes send buffers as-is
+    lv_display_set_color_format(_display, LV_COLOR_FORMAT_RGB565_SWAPPED);
     lv_display_set_flush_cb(_display, _disp_flush);
+    lv_display_set_flush_wait_cb(_display, _disp_flush_wait);
+    _panel->setFlushDoneCallback(_flush_done, _display);
     
     // Set the buffer correctly
     lv_display_set_buffers(
         _display, 
         _buf1, 
         _buf2, 
-        _screen_width * _buffer_rows * sizeof(lv_color_t),
+        _buffer_bytes,
         LV_DISPLAY_RENDER_MODE_PARTIAL
     );
     
@@ -111,22 +116,41 @@ void DisplayInterface::begin() {
     lv_obj_set_style_border_width(lv_scr_act(), 0, 0);
 }
 
-Adafruit_ST7789* DisplayInterface::getDisplay() {
-    return _tft;
+DisplayPanel* DisplayInterface::getPanel() {
+    return _panel;
 }
 
-void DisplayInterface::handleLVGLTasks() {
+uint32_t DisplayInterface::handleLVGLTasks() {
+    uint32_t next_ms = LV_NO_TIMER_READY;
     if (takeMutex()) {
-        lv_timer_handler();
+        next_ms = lv_timer_handler();
         giveMutex();
     }
+    return next_ms;
 }
 
-void DisplayInterface::tickTask(void* arg) {
-    (void)arg;  // Silence unused parameter warning
-    while (1) {
-        lv_tick_inc(10);
-        vTaskDelay(pdMS_TO_TICKS(10));
+void DisplayInterface::setLVGLTask(TaskHandle_t task) {
+    _lvgl_task = task;
+}
+
+void DisplayInterface::waitForWork(uint32_t timeout_ms) {
+    TickType_t timeout = timeout_ms == LV_NO_TIMER_READY ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    ulTaskNotifyTake(pdTRUE, timeout);
+}
+
+void DisplayInterface::wake() {
+    if (_lvgl_task) {
+        xTaskNotifyGive(_lvgl_task);
+    }
+}
+
+void IRAM_ATTR DisplayInterface::wakeFromISR() {
+    if (instance && instance->_lvgl_task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(instance->_lvgl_task, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
     }
 }
 
@@ -140,6 +164,9 @@ bool DisplayInterface::takeMutex(TickType_t timeout) {
 void DisplayInterface::giveMutex() {
     if (_lvgl_mutex) {
         xSemaphoreGive(_lvgl_mutex);
+        if (xTaskGetCurrentTaskHandle() != _lvgl_task) {
+            wake();
+        }
     }
 }
 
@@ -148,19 +175,35 @@ SemaphoreHandle_t* DisplayInterface::getMutexPtr() {
 }
 
 void DisplayInterface::_disp_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
-    if (instance && instance->_tft) {
+    if (instance && instance->_panel) {
         uint32_t w = (area->x2 - area->x1 + 1);
         uint32_t h = (area->y2 - area->y1 + 1);
+        TraceBuffer::Span span("lvgl.flush", w * h);
         
-        instance->_tft->startWrite();
-        instance->_tft->setAddrWindow(area->x1, area->y1, w, h);
-        instance->_tft->writePixels((uint16_t*)px_map, w * h);
-        instance->_tft->endWrite();
+        // On success the panel's DMA interrupt reports completion
+        if (instance->_panel->drawPixels(area->x1, area->y1, w, h, (const uint16_t*)px_map)) {
+            return;
+        }
     }
     
     lv_display_flush_ready(disp);
 }
 
+void DisplayInterface::_disp_flush_wait(lv_display_t* disp) {
+    (void)disp;
+    if (instance && instance->_panel) {
+        instance->_panel->waitForFlush();
+    }
+}
+
+void DisplayInterface::_flush_done(void* context) {
+    lv_display_flush_ready(static_cast<lv_display_t*>(context));
+}
+
+uint32_t DisplayInterface::_tick_ms() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
 DisplayInterface::~DisplayInterface() {
     // Free resources in reverse order of allocation
     if (_lvgl_mutex) {
@@ -168,21 +211,22 @@ DisplayInterface::~DisplayInterface() {
         _lvgl_mutex = nullptr;
     }
     
+    // Panel first, so no DMA is still reading the buffers
+    if (_panel) {
+        delete _panel;
+        _panel = nullptr;
+    }
+    
     if (_buf2) {
-        delete[] _buf2;  // Using delete[] for array allocations
+        heap_caps_free(_buf2);
         _buf2 = nullptr;
     }
     
     if (_buf1) {
-        delete[] _buf1;  // Using delete[] for array allocations
+        heap_caps_free(_buf1);
         _buf1 = nullptr;
     }
     
-    if (_tft) {
-        delete _tft;
-        _tft = nullptr;
-    }
-    
     // Reset the static instance pointer if it points to this object
     if (instance == this) {
         instance = nullptr;
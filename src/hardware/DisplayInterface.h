@@ -1,17 +1,22 @@
 #pragma once
 
 #include <Arduino.h>
-#include <SPI.h>
-#include <Adafruit_ST7789.h>
 #include <lvgl.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "DisplayPanel.h"
 
 /**
  * @brief Interface class for TFT display with LVGL integration
  * 
  * This class manages the initialization and operation of an ST7789 TFT display
  * through SPI and integrates it with the LVGL graphics library.
+ *
+ * Flushes are queued on the panel and complete from its DMA interrupt, so
+ * LVGL renders into one buffer while the other is still being sent.
+ *
+ * The LVGL task sleeps between LVGL deadlines; wake() and wakeFromISR()
+ * bring it back early when new UI work or input arrives.
  */
 class DisplayInterface {
 public:
@@ -47,23 +52,43 @@ public:
     void begin();
     
     /**
-     * @brief Get the underlying TFT display object
+     * @brief Get the panel LVGL flushes to
      * 
-     * @return Adafruit_ST7789* Pointer to the display
+     * @return DisplayPanel* Pointer to the panel
      */
-    Adafruit_ST7789* getDisplay();
+    DisplayPanel* getPanel();
     
     /**
-     * @brief Process LVGL tasks (should be called regularly)
+     * @brief Process LVGL tasks
+     * 
+     * @return uint32_t Milliseconds until LVGL next needs to run,
+     *         LV_NO_TIMER_READY if no timer is pending
+     */
+    uint32_t handleLVGLTasks();
+    
+    /**
+     * @brief Register the task that runs handleLVGLTasks()
+     * 
+     * @param task Task to wake when UI work arrives
      */
-    void handleLVGLTasks();
+    void setLVGLTask(TaskHandle_t task);
     
     /**
-     * @brief FreeRTOS task for LVGL tick handling
+     * @brief Sleep the LVGL task until a deadline or a wake
      * 
-     * @param arg Task argument (not used)
+     * @param timeout_ms Longest time to sleep, LV_NO_TIMER_READY for no limit
+     */
+    void waitForWork(uint32_t timeout_ms);
+    
+    /**
+     * @brief Wake the LVGL task to handle new work
+     */
+    void wake();
+    
+    /**
+     * @brief Wake the LVGL task from an interrupt handler
      */
-    static void tickTask(void* arg);
+    static void wakeFromISR();
     
     /**
      * @brief Acquire the LVGL mutex
@@ -76,6 +101,9 @@ public:
     
     /**
      * @brief Release the LVGL mutex
+     * 
+     * Wakes the LVGL task if another task held the mutex, since it may have
+     * changed objects that now need redrawing.
      */
     void giveMutex();
     
@@ -90,16 +118,18 @@ private:
     uint16_t _screen_width;
     uint16_t _screen_height;
     uint16_t _buffer_rows;
+    size_t _buffer_bytes;          ///< Size of each render buffer
     int8_t _cs_pin;
     int8_t _dc_pin;
     int8_t _rst_pin;
     int8_t _backlight_pin;
     
-    Adafruit_ST7789* _tft;
+    DisplayPanel* _panel;
     lv_display_t* _display;
-    lv_color_t* _buf1;
-    lv_color_t* _buf2;
+    uint8_t* _buf1;
+    uint8_t* _buf2;
     SemaphoreHandle_t _lvgl_mutex;
+    TaskHandle_t _lvgl_task;
     
     /**
      * @brief LVGL display flush callback
@@ -110,6 +140,25 @@ private:
      */
     static void _disp_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
     
+    /**
+     * @brief LVGL callback to wait for queued flushes, instead of spinning
+     * 
+     * @param disp LVGL display
+     */
+    static void _disp_flush_wait(lv_display_t* disp);
+    
+    /**
+     * @brief Panel callback for a finished flush (may run in ISR context)
+     * 
+     * @param context The LVGL display
+     */
+    static void _flush_done(void* context);
+    
+    /**
+     * @brief LVGL tick source, milliseconds since boot from esp_timer
+     */
+    static uint32_t _tick_ms();
+    
     // Prevent copying
     DisplayInterface(const DisplayInterface&) = delete;
     DisplayInterface& operator=(const DisplayInterface&) = delete;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class DisplayPanel
+ * @brief Pixel sink for LVGL flushes
+ *
+ * A panel queues a window of pixels and returns straight away; the transfer
+ * finishes in the background and the flush-done callback reports it. The
+ * pixels must stay untouched until then, which lets the renderer fill its
+ * other buffer while this one is still on the wire.
+ */
+class DisplayPanel {
+public:
+    /**
+     * @brief Called when a queued window has been sent
+     * @param context Pointer given to setFlushDoneCallback
+     *
+     * May run in interrupt context; keep it short and ISR-safe.
+     */
+    using FlushDoneCallback = void (*)(void* context);
+
+    DisplayPanel() : _onFlushDone(nullptr), _flushDoneContext(nullptr) {}
+    virtual ~DisplayPanel() = default;
+
+    /**
+     * @brief Reset and initialize the panel, leaving it cleared to black
+     * @return true if the panel is ready to take pixels
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Queue a window of RGB565 pixels, high byte first
+     * @param x Left edge
+     * @param y Top edge
+     * @param w Width in pixels
+     * @param h Height in pixels
+     * @param pixels w * h pixels, row-major; must stay valid until flush done
+     * @return false if the transfer couldn't be queued (no callback follows)
+     */
+    virtual bool drawPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) = 0;
+
+    /**
+     * @brief Block until every queued window has been sent
+     */
+    virtual void waitForFlush() = 0;
+
+    /**
+     * @brief Set the callback run after each queued window has been sent
+     */
+    void setFlushDoneCallback(FlushDoneCallback callback, void* context) {
+        _onFlushDone = callback;
+        _flushDoneContext = context;
+    }
+
+protected:
+    /**
+     * @brief Report a finished window (for implementations)
+     */
+    void notifyFlushDone() {
+        if (_onFlushDone) {
+            _onFlushDone(_flushDoneContext);
+        }
+    }
+
+private:
+    FlushDoneCallback _onFlushDone;
+    void* _flushDoneContext;
+
+    DisplayPanel(const DisplayPanel&) = delete;
+    DisplayPanel& operator=(const DisplayPanel&) = delete;
+};
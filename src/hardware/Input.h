@@ -28,6 +28,21 @@ public:
         buttons[BUTTON_UP].setPressedState(HIGH);
     }
 
+    /**
+     * @brief Call a handler on every edge of any button
+     * @param isr Interrupt handler, must be in IRAM
+     */
+    static void attachEdgeInterrupts(void (*isr)()) {
+        attachInterrupt(digitalPinToInterrupt(BUTTON_DOWN), isr, CHANGE);
+        attachInterrupt(digitalPinToInterrupt(BUTTON_CENTER), isr, CHANGE);
+        attachInterrupt(digitalPinToInterrupt(BUTTON_UP), isr, CHANGE);
+    }
+
+    static bool anyPressed() {
+        return buttons[BUTTON_DOWN].isPressed() || buttons[BUTTON_CENTER].isPressed() ||
+               buttons[BUTTON_UP].isPressed();
+    }
+
     static void update() {
         buttons[BUTTON_DOWN].update();
         buttons[BUTTON_CENTER].update();
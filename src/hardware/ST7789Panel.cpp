@@ -0,0 +1,160 @@
+#include "ST7789Panel.h"
+#include <SPI.h>
+#include <Adafruit_ST7789.h>
+#include <driver/spi_master.h>
+
+namespace {
+
+// The ESP32-S3's general-purpose SPI, the one the Arduino SPI object drives
+constexpr spi_host_device_t PANEL_SPI_HOST = SPI2_HOST;
+
+// Exposes the RAM offsets Adafruit_ST7789 works out for the glass and rotation
+class ST7789Init : public Adafruit_ST7789 {
+public:
+    using Adafruit_ST7789::Adafruit_ST7789;
+    uint16_t xOffset() const { return _xstart; }
+    uint16_t yOffset() const { return _ystart; }
+};
+
+}
+
+ST7789Panel::ST7789Panel(
+    uint16_t width,
+    uint16_t height,
+    int8_t cs_pin,
+    int8_t dc_pin,
+    int8_t rst_pin,
+    size_t max_transfer_bytes,
+    uint32_t pixel_clock_hz
+) : _width(width),
+    _height(height),
+    _cs_pin(cs_pin),
+    _dc_pin(dc_pin),
+    _rst_pin(rst_pin),
+    _max_transfer_bytes(max_transfer_bytes),
+    _pixel_clock_hz(pixel_clock_hz),
+    _x_offset(0),
+    _y_offset(0),
+    _bus_initialized(false),
+    _io(nullptr),
+    _in_flight(0),
+    _idle(xSemaphoreCreateBinary()) {
+}
+
+ST7789Panel::~ST7789Panel() {
+    if (_io) {
+        waitForFlush();
+        esp_lcd_panel_io_del(_io);
+        _io = nullptr;
+    }
+    if (_bus_initialized) {
+        spi_bus_free(PANEL_SPI_HOST);
+    }
+    if (_idle) {
+        vSemaphoreDelete(_idle);
+    }
+}
+
+bool ST7789Panel::begin() {
+    if (_idle == nullptr) {
+        Serial.println("[ST7789Panel] Could not create semaphore");
+        return false;
+    }
+
+    // Init sequence, rotation and clear through Adafruit, then release the bus
+    {
+        ST7789Init tft(&SPI, _cs_pin, _dc_pin, _rst_pin);
+        SPI.begin();
+        tft.init(_height, _width);
+        tft.setRotation(1);
+        tft.fillScreen(ST77XX_BLACK);
+        _x_offset = tft.xOffset();
+        _y_offset = tft.yOffset();
+        SPI.end();
+    }
+
+    spi_bus_config_t bus = {};
+    bus.sclk_io_num = SCK;
+    bus.mosi_io_num = MOSI;
+    bus.miso_io_num = -1;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = _max_transfer_bytes;
+
+    esp_err_t err = spi_bus_initialize(PANEL_SPI_HOST, &bus, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK) {
+        Serial.printf("[ST7789Panel] SPI bus init failed: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    _bus_initialized = true;
+
+    esp_lcd_panel_io_spi_config_t io = {};
+    io.cs_gpio_num = _cs_pin;
+    io.dc_gpio_num = _dc_pin;
+    io.spi_mode = 0;
+    io.pclk_hz = _pixel_clock_hz;
+    io.trans_queue_depth = TRANSFER_QUEUE_DEPTH;
+    io.on_color_trans_done = onTransferDone;
+    io.user_ctx = this;
+    io.lcd_cmd_bits = 8;
+    io.lcd_param_bits = 8;
+
+    err = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)PANEL_SPI_HOST, &io, &_io);
+    if (err != ESP_OK) {
+        Serial.printf("[ST7789Panel] Panel IO init failed: %s\n", esp_err_to_name(err));
+        _io = nullptr;
+        return false;
+    }
+
+    Serial.printf("[ST7789Panel] DMA transfers at %lu Hz, offset %u,%u\n",
+                  (unsigned long)_pixel_clock_hz, _x_offset, _y_offset);
+    return true;
+}
+
+bool ST7789Panel::drawPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    if (!_io) {
+        return false;
+    }
+
+    uint16_t x1 = x + _x_offset;
+    uint16_t x2 = x1 + w - 1;
+    uint16_t y1 = y + _y_offset;
+    uint16_t y2 = y1 + h - 1;
+    uint8_t columns[] = {(uint8_t)(x1 >> 8), (uint8_t)x1, (uint8_t)(x2 >> 8), (uint8_t)x2};
+    uint8_t rows[] = {(uint8_t)(y1 >> 8), (uint8_t)y1, (uint8_t)(y2 >> 8), (uint8_t)y2};
+
+    // Parameter writes wait for the previous window to finish, so windows never interleave
+    if (esp_lcd_panel_io_tx_param(_io, ST77XX_CASET, columns, sizeof(columns)) != ESP_OK ||
+        esp_lcd_panel_io_tx_param(_io, ST77XX_RASET, rows, sizeof(rows)) != ESP_OK) {
+        return false;
+    }
+
+    _in_flight.fetch_add(1);
+    if (esp_lcd_panel_io_tx_color(_io, ST77XX_RAMWR, pixels, (size_t)w * h * sizeof(uint16_t)) != ESP_OK) {
+        if (_in_flight.fetch_sub(1) == 1) {
+            xSemaphoreGive(_idle);
+        }
+        return false;
+    }
+    return true;
+}
+
+void ST7789Panel::waitForFlush() {
+    // A give left over from an earlier window just costs one more check
+    while (_in_flight.load() > 0) {
+        xSemaphoreTake(_idle, portMAX_DELAY);
+    }
+}
+
+bool ST7789Panel::onTransferDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t* event, void* context) {
+    (void)io;
+    (void)event;
+    ST7789Panel* panel = static_cast<ST7789Panel*>(context);
+
+    BaseType_t woken = pdFALSE;
+    if (panel->_in_flight.fetch_sub(1) == 1) {
+        xSemaphoreGiveFromISR(panel->_idle, &woken);
+    }
+    panel->notifyFlushDone();
+    return woken == pdTRUE;
+}
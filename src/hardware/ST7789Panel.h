@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_lcd_panel_io.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "DisplayPanel.h"
+
+/**
+ * @class ST7789Panel
+ * @brief ST7789 over SPI with DMA-queued pixel transfers
+ *
+ * Adafruit_ST7789 runs the panel's init sequence and rotation, since it
+ * knows the offsets of the 1.14" 135x240 glass. The SPI bus is then handed
+ * to the ESP-IDF LCD driver, which queues each window as DMA transactions
+ * and reports completion from its interrupt.
+ */
+class ST7789Panel : public DisplayPanel {
+public:
+    static constexpr uint32_t DEFAULT_PIXEL_CLOCK_HZ = 40000000;
+    static constexpr size_t TRANSFER_QUEUE_DEPTH = 4;   ///< Transactions the SPI driver holds at once
+
+    /**
+     * @param width Width in pixels after rotation
+     * @param height Height in pixels after rotation
+     * @param cs_pin Chip select pin
+     * @param dc_pin Data/command pin
+     * @param rst_pin Reset pin
+     * @param max_transfer_bytes Largest window drawPixels() will be given, in bytes
+     * @param pixel_clock_hz SPI clock for pixel data
+     */
+    ST7789Panel(
+        uint16_t width,
+        uint16_t height,
+        int8_t cs_pin,
+        int8_t dc_pin,
+        int8_t rst_pin,
+        size_t max_transfer_bytes,
+        uint32_t pixel_clock_hz = DEFAULT_PIXEL_CLOCK_HZ
+    );
+    ~ST7789Panel() override;
+
+    bool begin() override;
+    bool drawPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) override;
+    void waitForFlush() override;
+
+private:
+    /**
+     * @brief SPI driver callback for a finished pixel transfer (ISR context)
+     */
+    static bool onTransferDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t* event, void* context);
+
+    uint16_t _width;
+    uint16_t _height;
+    int8_t _cs_pin;
+    int8_t _dc_pin;
+    int8_t _rst_pin;
+    size_t _max_transfer_bytes;
+    uint32_t _pixel_clock_hz;
+
+    uint16_t _x_offset;                  ///< Column of the glass's left edge in panel RAM
+    uint16_t _y_offset;                  ///< Row of the glass's top edge in panel RAM
+    bool _bus_initialized;
+    esp_lcd_panel_io_handle_t _io;
+    std::atomic<uint32_t> _in_flight;    ///< Windows queued but not yet sent
+    SemaphoreHandle_t _idle;             ///< Given when _in_flight drops to zero
+};
@@ -86,12 +86,11 @@ void WiFiInterface::begin() {
     
     // Subscribe to WiFi credential events if event queue is available
     if (_eventQueue != nullptr) {
-        _eventQueue->subscribe([this](const Event& event) {
-            if (event.type == EventType::WIFI_CREDENTIALS_FOUND || 
-                event.type == EventType::NEED_WIFI_CREDENTIALS) {
+        for (EventType type : {EventType::WIFI_CREDENTIALS_FOUND, EventType::NEED_WIFI_CREDENTIALS}) {
+            _subscriptions.push_back(_eventQueue->subscribe(type, [this](const Event& event) {
                 this->handleWiFiCredentialEvent(event);
-            }
-        });
+            }));
+        }
     }
 }
 
@@ -32,6 +32,7 @@
 #include "esp_heap_caps.h" // For PSRAM management
 #include "ui/CardController.h"
 #include "EventQueue.h"
+#include "TraceBuffer.h"
 #include "esp_partition.h" // Include for partition functions
 #include "OtaManager.h"
 #include <esp_sleep.h> // Added for deep sleep functionality
@@ -41,7 +42,7 @@
 #define SCREEN_HEIGHT 135
 
 // LVGL display buffer size
-#define LVGL_BUFFER_ROWS 135  // Full screen height
+#define LVGL_BUFFER_ROWS 27   // A fifth of the screen; two DMA buffers of 13 KB in internal RAM
 
 // Button configuration
 #define NUM_BUTTONS 3
@@ -102,23 +103,38 @@ void insightTaskFunction(void* parameter) {
     }
 }
 
+// Set by the button interrupt, cleared once the LVGL task starts polling
+static volatile bool buttonEdge = false;
+
+void IRAM_ATTR onButtonEdge() {
+    buttonEdge = true;
+    DisplayInterface::wakeFromISR();
+}
+
 // LVGL handler task that includes button polling - added here to consolidate UI operations
 void lvglHandlerTask(void* parameter) {
     TickType_t lastButtonCheck = xTaskGetTickCount();
-    const TickType_t buttonCheckInterval = pdMS_TO_TICKS(50); // Check buttons every 50ms
+    const TickType_t buttonCheckInterval = pdMS_TO_TICKS(10); // Check buttons every 10ms while active
+    const TickType_t buttonSettleTime = pdMS_TO_TICKS(100);   // Keep checking this long after an edge
+    TickType_t buttonsActiveUntil = lastButtonCheck;
     
     static unsigned long powerOffPressStartTime = 0;
     // static bool upPressedState = false; // Unused
     // static bool downPressedState = false; // Unused
 
-    while (1) {
-        // Handle LVGL tasks
-        displayInterface->handleLVGLTasks();
+    // Sleep between LVGL deadlines; UI dispatch and button edges wake us early
+    displayInterface->setLVGLTask(xTaskGetCurrentTaskHandle());
+    Input::attachEdgeInterrupts(onButtonEdge);
 
-        cardController->processUIQueue();
+    while (1) {
+        TickType_t currentTime = xTaskGetTickCount();
+        if (buttonEdge) {
+            buttonEdge = false;
+            buttonsActiveUntil = currentTime + buttonSettleTime;
+            lastButtonCheck = currentTime - buttonCheckInterval;
+        }
         
         // Poll buttons at regular intervals
-        TickType_t currentTime = xTaskGetTickCount();
         if ((currentTime - lastButtonCheck) >= buttonCheckInterval) {
             lastButtonCheck = currentTime;
             
@@ -141,6 +157,7 @@ void lvglHandlerTask(void* parameter) {
                         Serial.println("Simultaneous CENTER and DOWN hold for 2s detected. Entering deep sleep.");
                         // Optional: Turn off display backlight or other peripherals before sleep
                         // displayInterface->setBacklight(0); // Example if such a function exists
+                        configManager->flushCardConfigs();
                         esp_deep_sleep_start();
                     }
                 }
@@ -166,7 +183,16 @@ void lvglHandlerTask(void* parameter) {
             }
         }
         
-        vTaskDelay(pdMS_TO_TICKS(5));
+        cardController->processUIQueue();
+
+        // Handle LVGL tasks
+        uint32_t idleMs = displayInterface->handleLVGLTasks();
+        
+        // Keep polling while a button is down or settling, for debounce, releases and the power-off hold
+        if (Input::anyPressed() || (int32_t)(buttonsActiveUntil - xTaskGetTickCount()) > 0) {
+            idleMs = std::min<uint32_t>(idleMs, pdTICKS_TO_MS(buttonCheckInterval));
+        }
+        displayInterface->waitForWork(idleMs);
     }
 }
 
@@ -216,6 +242,9 @@ void setup() {
     }
     Serial.println("--------------------------");
 
+    // Trace ring lives in PSRAM, so start it once PSRAM is up
+    TraceBuffer::begin();
+
     // UI queue will be initialized by CardController
 
 
@@ -269,6 +298,10 @@ void setup() {
     
     // Initialize OtaManager
     otaManager = new OtaManager(CURRENT_FIRMWARE_VERSION, "PostHog", "DeskHog");
+    // Card edits still waiting for their debounced commit must survive the reboot
+    otaManager->setBeforeRestart([]() {
+        configManager->flushCardConfigs();
+    });
     
     // Initialize captive portal
     captivePortal = new CaptivePortal(*configManager, *wifiInterface, *eventQueue, *otaManager, *cardController);
@@ -307,17 +340,6 @@ void setup() {
         0
     );
     
-    // Create LVGL tick task
-    xTaskCreatePinnedToCore(
-        DisplayInterface::tickTask,
-        "lv_tick_task",
-        2048,
-        NULL,
-        1,
-        NULL,
-        1
-    );
-    
     // Create LVGL handler task (now includes button polling)
     xTaskCreatePinnedToCore(
         lvglHandlerTask,
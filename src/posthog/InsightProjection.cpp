@@ -0,0 +1,171 @@
+#include "InsightProjection.h"
+#include "parsers/InsightParser.h"
+#include <algorithm>
+
+namespace {
+
+// Largest document we'll build, same budget as InsightParser
+const size_t MAX_DOCUMENT_SIZE = 65536;
+
+String wrapHogQL(String sql, InsightProjection::Shape shape) {
+    sql.trim();
+    while (sql.endsWith(";")) {
+        sql.remove(sql.length() - 1);
+        sql.trim();
+    }
+
+    if (shape == InsightProjection::Shape::LAST_VALUE) {
+        // Numeric cards show the first column of the first row
+        return "SELECT * FROM (" + sql + ") LIMIT 1";
+    }
+
+    // Newest points first to apply the limit, then back into chart order
+    return "SELECT * FROM (SELECT * FROM (" + sql + ") ORDER BY 1 DESC LIMIT " +
+           String((unsigned)InsightProjection::MAX_SERIES_POINTS) + ") ORDER BY 1 ASC";
+}
+
+// Trim a query to what the card draws, without changing any number it shows
+void narrowSource(JsonObject source, InsightProjection::Shape shape) {
+    const char* kind = source["kind"] | "";
+    if (strcmp(kind, "HogQLQuery") == 0) {
+        source[JSON_KEY_QUERY] = wrapHogQL(source[JSON_KEY_QUERY].as<String>(), shape);
+    } else if (strcmp(kind, "TrendsQuery") == 0) {
+        // The number shown is the first series' aggregate for the current period
+        source.remove("compareFilter");
+        JsonObject breakdown = source["breakdownFilter"];
+        bool combinesSeries = !source["trendsFilter"]["formula"].isNull() ||
+                              !breakdown[JSON_KEY_BREAKDOWN].isNull() || !breakdown["breakdowns"].isNull();
+        JsonArray series = source["series"];
+        while (!combinesSeries && series.size() > 1) {
+            series.remove(series.size() - 1);
+        }
+    } else if (strcmp(kind, "FunnelsQuery") == 0) {
+        // Funnels ask for the biggest breakdowns first; the renderer draws only a few
+        JsonObject breakdown = source["breakdownFilter"];
+        if (!breakdown[JSON_KEY_BREAKDOWN].isNull() || !breakdown["breakdowns"].isNull()) {
+            int limit = breakdown["breakdown_limit"] | InsightProjection::MAX_FUNNEL_BREAKDOWNS;
+            breakdown["breakdown_limit"] = std::min(limit, InsightProjection::MAX_FUNNEL_BREAKDOWNS);
+        }
+    }
+}
+
+}
+
+bool InsightProjection::extractTemplate(const String& response, Template& tmpl) {
+    StaticJsonDocument<256> filter;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_NAME] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_QUERY] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_FILTERS][JSON_KEY_INSIGHT] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_FILTERS][JSON_KEY_EVENTS] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_FILTERS][JSON_KEY_ACTIONS] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_FILTERS][JSON_KEY_FUNNEL_WINDOW_INTERVAL] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_FILTERS][JSON_KEY_FUNNEL_WINDOW_INTERVAL_UNIT] = true;
+    filter[JSON_KEY_RESULTS][0][JSON_KEY_COMPARE] = true;
+
+    DynamicJsonDocument doc(32768);
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+    if (error) {
+        Serial.printf("[InsightProjection] Failed to read insight definition: %s\n", error.c_str());
+        return false;
+    }
+
+    JsonObject insight = doc[JSON_KEY_RESULTS][0];
+    JsonObject query = insight[JSON_KEY_QUERY];
+    JsonObject source = query["source"];
+    if (insight.isNull() || source.isNull()) {
+        return false;
+    }
+
+    const char* sourceKind = source["kind"] | "";
+    const char* insightKind = insight[JSON_KEY_FILTERS][JSON_KEY_INSIGHT] | "";
+    const char* display = query[JSON_KEY_DISPLAY] | "";
+
+    Shape shape = Shape::NONE;
+    if (strcmp(insightKind, JSON_VAL_INSIGHT_FUNNELS) == 0 && strcmp(sourceKind, "FunnelsQuery") == 0) {
+        shape = Shape::FUNNEL_STEPS;
+    } else if (strcmp(sourceKind, "HogQLQuery") == 0 && source[JSON_KEY_QUERY].is<const char*>()) {
+        shape = strcmp(display, JSON_VAL_DISPLAY_BOLD_NUMBER) == 0 ? Shape::LAST_VALUE : Shape::SERIES;
+    } else if (strcmp(sourceKind, "TrendsQuery") == 0 &&
+               strcmp(source["trendsFilter"][JSON_KEY_DISPLAY] | "", JSON_VAL_DISPLAY_BOLD_NUMBER) == 0) {
+        shape = Shape::LAST_VALUE;
+    }
+
+    if (shape == Shape::NONE) {
+        return false;
+    }
+
+    // The query to POST: the insight's own source, narrowed to what the card draws
+    narrowSource(source, shape);
+    String projectedQuery;
+    serializeJson(source, projectedQuery);
+
+    // The skeleton keeps exactly the fields InsightParser filters for
+    DynamicJsonDocument skeleton(4096);
+    JsonObject skeletonInsight = skeleton.createNestedArray(JSON_KEY_RESULTS).createNestedObject();
+    JsonObject skeletonQuery = skeletonInsight.createNestedObject(JSON_KEY_QUERY);
+    for (const char* key : {JSON_KEY_DISPLAY, JSON_KEY_CHART_SETTINGS, JSON_KEY_TABLE_SETTINGS}) {
+        if (query.containsKey(key)) {
+            skeletonQuery[key] = query[key];
+        }
+    }
+    for (const char* key : {JSON_KEY_NAME, JSON_KEY_FILTERS, JSON_KEY_COMPARE}) {
+        if (insight.containsKey(key)) {
+            skeletonInsight[key] = insight[key];
+        }
+    }
+    if (skeleton.overflowed()) {
+        return false;
+    }
+
+    tmpl.shape = shape;
+    tmpl.query = projectedQuery;
+    tmpl.skeleton = "";
+    serializeJson(skeleton, tmpl.skeleton);
+    tmpl.createdAt = millis();
+    return true;
+}
+
+String InsightProjection::buildRequestBody(const Template& tmpl, const char* refreshMode) {
+    String body;
+    body.reserve(tmpl.query.length() + 40);
+    body += "{\"query\":";
+    body += tmpl.query;
+    body += ",\"refresh\":\"";
+    body += refreshMode;
+    body += "\"}";
+    return body;
+}
+
+bool InsightProjection::buildSnapshot(const Template& tmpl, const String& response, String& snapshot) {
+    StaticJsonDocument<64> filter;
+    filter[JSON_KEY_RESULTS] = true;
+
+    DynamicJsonDocument results(std::min<size_t>(MAX_DOCUMENT_SIZE, response.length() * 4 + 1024));
+    DeserializationError error = deserializeJson(results, response, DeserializationOption::Filter(filter));
+    if (error || results.overflowed()) {
+        Serial.printf("[InsightProjection] Failed to read query response: %s\n", error.c_str());
+        return false;
+    }
+
+    // No rows is a valid answer: the card shows it just as it would from a full fetch
+    JsonArray rows = results[JSON_KEY_RESULTS];
+    if (rows.isNull()) {
+        return false;
+    }
+
+    DynamicJsonDocument doc(std::min<size_t>(MAX_DOCUMENT_SIZE, tmpl.skeleton.length() * 2 + results.memoryUsage() + 1024));
+    error = deserializeJson(doc, tmpl.skeleton);
+    if (error) {
+        return false;
+    }
+
+    doc[JSON_KEY_RESULTS][0][JSON_KEY_RESULT] = rows;
+    if (doc.overflowed()) {
+        Serial.println("[InsightProjection] Query response too large to wrap");
+        return false;
+    }
+
+    snapshot = "";
+    serializeJson(doc, snapshot);
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class InsightProjection
+ * @brief Builds small query API requests that return only what a card renders
+ *
+ * The insights endpoint returns the whole insight object: filters, query
+ * definition, metadata and results. Once one full fetch has shown us the
+ * insight's query, later refreshes can go to the query endpoint instead and
+ * ask for exactly the rendered shape:
+ * - Numeric cards: the first row of a HogQL result, or for a trends query
+ *   the first series without the comparison period
+ * - Line and area graphs: the most recent MAX_SERIES_POINTS HogQL rows
+ * - Funnels: the step counts, with at most MAX_FUNNEL_BREAKDOWNS breakdowns
+ *
+ * The query response is then wrapped back into the insight layout
+ * InsightParser expects, so nothing downstream needs to know which
+ * endpoint the data came from.
+ *
+ * Everything else keeps using full fetches. Trends line graphs aren't
+ * projected because the line renderer draws HogQL rows, not trends series.
+ * Date ranges and intervals are never narrowed: that would change the
+ * numbers a card shows. Trends series are only dropped when no formula or
+ * breakdown combines them.
+ */
+class InsightProjection {
+public:
+    /**
+     * @enum Shape
+     * @brief What the projected query returns
+     */
+    enum class Shape {
+        NONE,           ///< Insight can't be projected, use full fetches
+        LAST_VALUE,     ///< Single row for numeric cards
+        SERIES,         ///< Last N rows of a time series
+        FUNNEL_STEPS    ///< Funnel step counts
+    };
+
+    /**
+     * @struct Template
+     * @brief Everything needed to refresh one insight through the query API
+     */
+    struct Template {
+        Shape shape = Shape::NONE;   ///< Projection kind
+        String query;                ///< Query object to POST, without refresh mode
+        String skeleton;             ///< Compact insight JSON with an empty result
+        unsigned long createdAt = 0; ///< When the template was extracted
+    };
+
+    /**
+     * @brief Derive a projection template from a full insight response
+     * @param response Raw response from the insights endpoint
+     * @param tmpl Output template
+     * @return true if the insight has a query we know how to project
+     */
+    static bool extractTemplate(const String& response, Template& tmpl);
+
+    /**
+     * @brief Build the query endpoint request body
+     * @param tmpl Template from extractTemplate()
+     * @param refreshMode Query API refresh mode (e.g. "blocking")
+     * @return JSON request body
+     */
+    static String buildRequestBody(const Template& tmpl, const char* refreshMode);
+
+    /**
+     * @brief Wrap a query endpoint response in the insight layout
+     * @param tmpl Template the request was built from
+     * @param response Raw response from the query endpoint
+     * @param snapshot Output insight JSON accepted by InsightParser
+     * @return true if the response carried a results array, even an empty one
+     */
+    static bool buildSnapshot(const Template& tmpl, const String& response, String& snapshot);
+
+    static constexpr size_t MAX_SERIES_POINTS = 120;                  ///< Two pixels per point on a 240px screen
+    static constexpr int MAX_FUNNEL_BREAKDOWNS = 5;                    ///< Matches FunnelRenderer::MAX_BREAKDOWNS
+    static constexpr unsigned long TEMPLATE_MAX_AGE = 60 * 60 * 1000;  ///< Re-read the insight definition hourly
+};
@@ -0,0 +1,210 @@
+#include "LanHub.h"
+#include "parsers/InsightParser.h"
+#include <algorithm>
+
+LanHub::LanHub(HubRole role)
+    : _role(role)
+    , _group(239, 255, 80, 72)
+    , _socketOpen(false)
+    , _nextSeq(esp_random())
+    , _mutex(xSemaphoreCreateMutex()) {
+    if (_role != HubRole::STANDALONE) {
+        Serial.printf("[LanHub] Running as %s on %s:%u\n",
+                      hubRoleToString(_role).c_str(), _group.toString().c_str(), MULTICAST_PORT);
+    }
+}
+
+LanHub::~LanHub() {
+    if (_socketOpen) {
+        _udp.stop();
+    }
+    if (_mutex != nullptr) {
+        vSemaphoreDelete(_mutex);
+    }
+}
+
+bool LanHub::ensureSocket() {
+    if (WiFi.status() != WL_CONNECTED) {
+        if (_socketOpen) {
+            // The group membership dies with the interface, rejoin after reconnect
+            _udp.stop();
+            _socketOpen = false;
+        }
+        return false;
+    }
+
+    if (!_socketOpen) {
+        _socketOpen = _udp.beginMulticast(_group, MULTICAST_PORT);
+        if (!_socketOpen) {
+            Serial.println("[LanHub] Failed to join multicast group");
+        }
+    }
+    return _socketOpen;
+}
+
+void LanHub::process() {
+    if (_role == HubRole::STANDALONE) {
+        return;
+    }
+
+    if (xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    if (!ensureSocket()) {
+        xSemaphoreGive(_mutex);
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_PACKETS_PER_PROCESS; i++) {
+        int packetSize = _udp.parsePacket();
+        if (packetSize <= 0) {
+            break;
+        }
+
+        size_t length = _udp.read(_packet, sizeof(_packet));
+        PacketHeader header;
+        size_t payloadOffset = LanHubProtocol::decodeHeader(_packet, length, header);
+        if (payloadOffset == 0) {
+            continue;
+        }
+
+        if (_role == HubRole::FOLLOWER && header.type == PacketType::SNAPSHOT) {
+            String completed;
+            if (_reassembly.addChunk(header, _packet + payloadOffset, length - payloadOffset, millis(), completed)) {
+                // Hand off outside the lock; the handler publishes events and may take a while
+                xSemaphoreGive(_mutex);
+                if (_onSnapshot) {
+                    _onSnapshot(header.insightId, completed);
+                }
+                if (xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) {
+                    return;
+                }
+            }
+        } else if (_role == HubRole::HUB && header.type == PacketType::REQUEST) {
+            if (handleRequest(header)) {
+                xSemaphoreGive(_mutex);
+                if (_onRequest) {
+                    _onRequest(header.insightId, (header.flags & LanHubProtocol::FLAG_FORCE_REFRESH) != 0);
+                }
+                if (xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) {
+                    return;
+                }
+            }
+        }
+    }
+
+    if (_role == HubRole::FOLLOWER) {
+        _reassembly.prune(millis());
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void LanHub::publishSnapshot(const String& insightId, const String& response) {
+    if (_role != HubRole::HUB) {
+        return;
+    }
+
+    // Strip the response down to what followers render before it hits the air
+    String compact;
+    {
+        InsightParser parser(response.c_str());
+        if (!parser.serializeSnapshot(compact)) {
+            Serial.printf("[LanHub] Not sharing %s, response did not parse\n", insightId.c_str());
+            return;
+        }
+    }
+
+    if (xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    Snapshot& snapshot = _snapshots[insightId];
+    snapshot.json = compact;
+    snapshot.seq = _nextSeq++;
+    snapshot.updatedAt = millis();
+    snapshot.sentAt = 0;
+
+    if (ensureSocket()) {
+        sendSnapshot(insightId, snapshot);
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void LanHub::requestInsight(const String& insightId, bool forceRefresh) {
+    if (_role != HubRole::FOLLOWER) {
+        return;
+    }
+
+    if (xSemaphoreTake(_mutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    if (ensureSocket()) {
+        sendPacket(PacketType::REQUEST, forceRefresh ? LanHubProtocol::FLAG_FORCE_REFRESH : 0, 0, 0, 1, insightId, nullptr, 0);
+    }
+
+    xSemaphoreGive(_mutex);
+}
+
+void LanHub::sendSnapshot(const String& insightId, Snapshot& snapshot) {
+    size_t chunkSize = MAX_PACKET_SIZE - LanHubProtocol::HEADER_SIZE - insightId.length();
+    size_t total = snapshot.json.length();
+    size_t chunkCount = (total + chunkSize - 1) / chunkSize;
+
+    if (chunkCount == 0 || chunkCount > MAX_CHUNKS) {
+        Serial.printf("[LanHub] Snapshot for %s is %u bytes, too large to share\n",
+                      insightId.c_str(), (unsigned)total);
+        return;
+    }
+
+    const char* data = snapshot.json.c_str();
+    for (size_t i = 0; i < chunkCount; i++) {
+        size_t offset = i * chunkSize;
+        size_t length = std::min(chunkSize, total - offset);
+        if (!sendPacket(PacketType::SNAPSHOT, 0, snapshot.seq, (uint8_t)i, (uint8_t)chunkCount,
+                        insightId, data + offset, length)) {
+            Serial.printf("[LanHub] Failed to send chunk %u/%u of %s\n",
+                          (unsigned)(i + 1), (unsigned)chunkCount, insightId.c_str());
+            return;
+        }
+    }
+
+    snapshot.sentAt = millis();
+    Serial.printf("[LanHub] Shared %s (%u bytes, %u packets)\n",
+                  insightId.c_str(), (unsigned)total, (unsigned)chunkCount);
+}
+
+bool LanHub::sendPacket(PacketType type, uint8_t flags, uint32_t seq, uint8_t chunkIndex, uint8_t chunkCount,
+                        const String& insightId, const char* payload, size_t payloadLength) {
+    size_t headerLength = LanHubProtocol::encodeHeader(_packet, sizeof(_packet), type, flags, seq, chunkIndex, chunkCount, insightId);
+    if (headerLength == 0 || headerLength + payloadLength > sizeof(_packet)) {
+        return false;
+    }
+
+    if (!_udp.beginMulticastPacket()) {
+        return false;
+    }
+    _udp.write(_packet, headerLength);
+    if (payloadLength > 0) {
+        _udp.write(reinterpret_cast<const uint8_t*>(payload), payloadLength);
+    }
+    return _udp.endPacket();
+}
+
+bool LanHub::handleRequest(const PacketHeader& header) {
+    bool forceRefresh = (header.flags & LanHubProtocol::FLAG_FORCE_REFRESH) != 0;
+
+    auto it = _snapshots.find(header.insightId);
+    if (forceRefresh || it == _snapshots.end() || millis() - it->second.updatedAt >= SNAPSHOT_MAX_AGE) {
+        return true;
+    }
+
+    // Several followers asking at once only costs one resend
+    if (it->second.sentAt == 0 || millis() - it->second.sentAt >= RESEND_HOLDOFF) {
+        sendSnapshot(header.insightId, it->second);
+    }
+    return false;
+}
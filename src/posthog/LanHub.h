@@ -0,0 +1,167 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <functional>
+#include <map>
+#include <vector>
+#include "../config/HubRole.h"
+#include "LanHubProtocol.h"
+
+/**
+ * @class LanHub
+ * @brief Shares insight data between desk units over UDP multicast
+ *
+ * Features:
+ * - Hub devices multicast a compact snapshot of every insight they fetch
+ * - Follower devices ask the hub for insights instead of calling PostHog
+ * - Snapshots larger than one datagram are split into chunks and reassembled
+ * - Hubs answer repeat requests from their snapshot cache without refetching
+ *
+ * With one hub on the LAN, PostHog sees one fetch per card instead of one
+ * per card per device. Standalone devices never open the socket. The wire
+ * format is described in LanHubProtocol.
+ *
+ * Thread-safe: sends and receives are serialized by an internal mutex.
+ */
+class LanHub {
+public:
+    /**
+     * @brief Callback for a complete snapshot received from the hub
+     * @param insightId ID of the insight
+     * @param json Compact insight JSON, accepted by InsightParser
+     */
+    using SnapshotHandler = std::function<void(const String& insightId, const String& json)>;
+
+    /**
+     * @brief Callback for a follower asking the hub for an insight
+     * @param insightId ID of the insight
+     * @param forceRefresh Whether the follower wants recalculated data
+     */
+    using RequestHandler = std::function<void(const String& insightId, bool forceRefresh)>;
+
+    /**
+     * @brief Constructor
+     * @param role Role of this device on the LAN
+     */
+    explicit LanHub(HubRole role);
+
+    ~LanHub();
+
+    // Delete copy constructor and assignment operator
+    LanHub(const LanHub&) = delete;
+    void operator=(const LanHub&) = delete;
+
+    /**
+     * @brief Get the role of this device
+     * @return Role the hub was created with
+     */
+    HubRole getRole() const { return _role; }
+
+    bool isHub() const { return _role == HubRole::HUB; }
+    bool isFollower() const { return _role == HubRole::FOLLOWER; }
+
+    /**
+     * @brief Set handler for snapshots received by a follower
+     * @param handler Called on the task driving process()
+     */
+    void setSnapshotHandler(SnapshotHandler handler) { _onSnapshot = handler; }
+
+    /**
+     * @brief Set handler for requests a hub can't answer from its cache
+     * @param handler Called on the task driving process()
+     */
+    void setRequestHandler(RequestHandler handler) { _onRequest = handler; }
+
+    /**
+     * @brief Join the multicast group and drain incoming packets
+     *
+     * Should be called regularly. Does nothing for standalone devices or
+     * while WiFi is down; the socket is reopened after a reconnect.
+     */
+    void process();
+
+    /**
+     * @brief Multicast fresh insight data to followers (hub only)
+     * @param insightId ID of the insight
+     * @param response Raw PostHog insight response
+     *
+     * The response is reduced to the fields the parser reads before sending.
+     */
+    void publishSnapshot(const String& insightId, const String& response);
+
+    /**
+     * @brief Ask the hub for an insight (follower only)
+     * @param insightId ID of the insight
+     * @param forceRefresh Whether to ask for recalculated data
+     */
+    void requestInsight(const String& insightId, bool forceRefresh);
+
+    static constexpr uint16_t MULTICAST_PORT = 45480;           ///< UDP port shared by hub and followers
+    static constexpr size_t MAX_PACKET_SIZE = 1400;             ///< Stay under a typical WiFi MTU
+    static constexpr uint8_t MAX_CHUNKS = LanHubProtocol::MAX_CHUNKS;                      ///< Largest snapshot is ~43KB
+    static constexpr size_t MAX_INSIGHT_ID_LENGTH = LanHubProtocol::MAX_INSIGHT_ID_LENGTH;  ///< Matches ConfigManager limit
+    static constexpr unsigned long RESEND_HOLDOFF = 5000;       ///< Min gap between resends of one snapshot
+    static constexpr unsigned long SNAPSHOT_MAX_AGE = 5 * 60 * 1000; ///< Cached snapshots older than this are refetched
+    static constexpr unsigned long REASSEMBLY_TIMEOUT = SnapshotReassembler::TIMEOUT;       ///< Drop partial snapshots after this long
+    static constexpr uint8_t MAX_PACKETS_PER_PROCESS = 16;      ///< Bound time spent in process()
+
+private:
+    using PacketType = LanHubProtocol::PacketType;
+    using PacketHeader = LanHubProtocol::PacketHeader;
+
+    /**
+     * @struct Snapshot
+     * @brief Last compact snapshot the hub sent for an insight
+     */
+    struct Snapshot {
+        String json;                 ///< Compact insight JSON
+        uint32_t seq;                ///< Sequence number it was sent with
+        unsigned long updatedAt;     ///< When the data was fetched
+        unsigned long sentAt;        ///< When it was last multicast
+    };
+
+    /**
+     * @brief Open the multicast socket if WiFi is up
+     * @return true if the socket is ready
+     *
+     * Caller must hold _mutex.
+     */
+    bool ensureSocket();
+
+    /**
+     * @brief Multicast a snapshot in as many chunks as needed
+     *
+     * Caller must hold _mutex.
+     */
+    void sendSnapshot(const String& insightId, Snapshot& snapshot);
+
+    /**
+     * @brief Multicast a single packet
+     *
+     * Caller must hold _mutex.
+     */
+    bool sendPacket(PacketType type, uint8_t flags, uint32_t seq, uint8_t chunkIndex, uint8_t chunkCount,
+                    const String& insightId, const char* payload, size_t payloadLength);
+
+    /**
+     * @brief Handle an insight request (hub)
+     * @return true if the request must be forwarded to the request handler
+     *
+     * Caller must hold _mutex.
+     */
+    bool handleRequest(const PacketHeader& header);
+
+    HubRole _role;                                   ///< Role of this device
+    WiFiUDP _udp;                                    ///< Multicast socket
+    IPAddress _group;                                ///< Multicast group address
+    bool _socketOpen;                                ///< Socket joined to the group
+    uint32_t _nextSeq;                               ///< Sequence number for the next snapshot
+    uint8_t _packet[MAX_PACKET_SIZE];                ///< Send/receive buffer
+    std::map<String, Snapshot> _snapshots;           ///< Hub: last snapshot per insight
+    SnapshotReassembler _reassembly;                 ///< Follower: snapshots being received
+    SnapshotHandler _onSnapshot;                     ///< Follower: complete snapshot callback
+    RequestHandler _onRequest;                       ///< Hub: uncached request callback
+    SemaphoreHandle_t _mutex;                        ///< Guards socket and maps
+};
@@ -0,0 +1,113 @@
+#include "LanHubProtocol.h"
+
+const uint8_t LanHubProtocol::MAGIC[4] = {'P', 'H', 'L', 'H'};
+
+size_t LanHubProtocol::encodeHeader(uint8_t* buffer, size_t bufferSize, PacketType type, uint8_t flags,
+                                    uint32_t seq, uint8_t chunkIndex, uint8_t chunkCount, const String& insightId) {
+    size_t idLength = insightId.length();
+    if (idLength == 0 || idLength > MAX_INSIGHT_ID_LENGTH || HEADER_SIZE + idLength > bufferSize) {
+        return 0;
+    }
+
+    memcpy(buffer, MAGIC, sizeof(MAGIC));
+    buffer[4] = PROTOCOL_VERSION;
+    buffer[5] = static_cast<uint8_t>(type);
+    buffer[6] = flags;
+    buffer[7] = (uint8_t)idLength;
+    buffer[8] = (uint8_t)(seq);
+    buffer[9] = (uint8_t)(seq >> 8);
+    buffer[10] = (uint8_t)(seq >> 16);
+    buffer[11] = (uint8_t)(seq >> 24);
+    buffer[12] = chunkIndex;
+    buffer[13] = chunkCount;
+    buffer[14] = 0;
+    buffer[15] = 0;
+    memcpy(buffer + HEADER_SIZE, insightId.c_str(), idLength);
+
+    return HEADER_SIZE + idLength;
+}
+
+size_t LanHubProtocol::decodeHeader(const uint8_t* buffer, size_t length, PacketHeader& header) {
+    if (length < HEADER_SIZE || memcmp(buffer, MAGIC, sizeof(MAGIC)) != 0 || buffer[4] != PROTOCOL_VERSION) {
+        return 0;
+    }
+
+    uint8_t type = buffer[5];
+    if (type != static_cast<uint8_t>(PacketType::SNAPSHOT) && type != static_cast<uint8_t>(PacketType::REQUEST)) {
+        return 0;
+    }
+
+    size_t idLength = buffer[7];
+    if (idLength == 0 || idLength > MAX_INSIGHT_ID_LENGTH || HEADER_SIZE + idLength > length) {
+        return 0;
+    }
+
+    header.type = static_cast<PacketType>(type);
+    header.flags = buffer[6];
+    header.seq = (uint32_t)buffer[8] | ((uint32_t)buffer[9] << 8) |
+                 ((uint32_t)buffer[10] << 16) | ((uint32_t)buffer[11] << 24);
+    header.chunkIndex = buffer[12];
+    header.chunkCount = buffer[13];
+    if (header.chunkCount == 0 || header.chunkCount > MAX_CHUNKS || header.chunkIndex >= header.chunkCount) {
+        return 0;
+    }
+
+    char id[MAX_INSIGHT_ID_LENGTH + 1];
+    memcpy(id, buffer + HEADER_SIZE, idLength);
+    id[idLength] = '\0';
+    header.insightId = String(id);
+
+    return HEADER_SIZE + idLength;
+}
+
+bool SnapshotReassembler::addChunk(const LanHubProtocol::PacketHeader& header, const uint8_t* payload,
+                                   size_t payloadLength, unsigned long now, String& completed) {
+    Entry& entry = _entries[header.insightId];
+
+    // A new sequence number means the hub has newer data; abandon the old one
+    if (entry.chunks.empty() || entry.seq != header.seq || entry.chunks.size() != header.chunkCount) {
+        entry.seq = header.seq;
+        entry.received = 0;
+        entry.chunks.assign(header.chunkCount, String());
+        entry.startedAt = now;
+    }
+
+    String& chunk = entry.chunks[header.chunkIndex];
+    if (!chunk.isEmpty() || payloadLength == 0) {
+        return false; // Duplicate or empty chunk
+    }
+
+    chunk.reserve(payloadLength);
+    for (size_t i = 0; i < payloadLength; i++) {
+        chunk += (char)payload[i];
+    }
+    entry.received++;
+
+    if (entry.received < header.chunkCount) {
+        return false;
+    }
+
+    size_t total = 0;
+    for (const auto& part : entry.chunks) {
+        total += part.length();
+    }
+    completed.reserve(total);
+    for (const auto& part : entry.chunks) {
+        completed += part;
+    }
+
+    _entries.erase(header.insightId);
+    return true;
+}
+
+void SnapshotReassembler::prune(unsigned long now) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (now - it->second.startedAt >= TIMEOUT) {
+            Serial.printf("[LanHub] Dropping incomplete snapshot for %s (%u/%u chunks)\n",
+                          it->first.c_str(), it->second.received, (unsigned)it->second.chunks.size());
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
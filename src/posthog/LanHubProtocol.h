@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+/**
+ * @class LanHubProtocol
+ * @brief Wire format LanHub speaks between desk units
+ *
+ * Wire format, all multi-byte fields little-endian:
+ *
+ *     magic[4] "PHLH" | version | type | flags | id_len |
+ *     seq[4] | chunk_index | chunk_count | reserved[2] | id | payload
+ *
+ * Encoding and decoding only, no socket, so the format can be tested
+ * off-device.
+ */
+class LanHubProtocol {
+public:
+    /**
+     * @enum PacketType
+     * @brief Kinds of datagrams on the wire
+     */
+    enum class PacketType : uint8_t {
+        SNAPSHOT = 1,   ///< Hub to followers: one chunk of an insight snapshot
+        REQUEST = 2     ///< Follower to hub: please send this insight
+    };
+
+    /**
+     * @struct PacketHeader
+     * @brief Decoded fixed header plus insight ID
+     */
+    struct PacketHeader {
+        PacketType type;
+        uint8_t flags;
+        uint32_t seq;
+        uint8_t chunkIndex;
+        uint8_t chunkCount;
+        String insightId;
+    };
+
+    /**
+     * @brief Encode a packet header into a buffer
+     * @return Bytes written, 0 if the insight ID is empty or too long
+     */
+    static size_t encodeHeader(uint8_t* buffer, size_t bufferSize, PacketType type, uint8_t flags,
+                               uint32_t seq, uint8_t chunkIndex, uint8_t chunkCount, const String& insightId);
+
+    /**
+     * @brief Decode a packet header from a datagram
+     * @param header Output header
+     * @return Offset of the payload, 0 if the packet is malformed or foreign
+     */
+    static size_t decodeHeader(const uint8_t* buffer, size_t length, PacketHeader& header);
+
+    static constexpr uint8_t MAX_CHUNKS = 32;                   ///< Largest snapshot is ~43KB
+    static constexpr size_t MAX_INSIGHT_ID_LENGTH = 64;         ///< Matches ConfigManager limit
+    static constexpr size_t HEADER_SIZE = 16;                   ///< Fixed header bytes before the insight ID
+    static constexpr uint8_t FLAG_FORCE_REFRESH = 0x01;         ///< REQUEST: recalculate instead of cache
+    static constexpr uint8_t PROTOCOL_VERSION = 1;              ///< Bumped on incompatible wire changes
+    static const uint8_t MAGIC[4];                              ///< "PHLH"
+};
+
+/**
+ * @class SnapshotReassembler
+ * @brief Joins the chunks of hub snapshots back together on a follower
+ *
+ * Chunks may arrive in any order. A chunk with a new sequence number means
+ * the hub has newer data and abandons the partial snapshot; a snapshot that
+ * stops arriving is dropped by prune().
+ *
+ * Not thread-safe; LanHub calls it under its mutex.
+ */
+class SnapshotReassembler {
+public:
+    /**
+     * @brief Add one received chunk
+     * @param header Decoded header of the chunk
+     * @param payload Chunk bytes
+     * @param payloadLength Number of chunk bytes
+     * @param now Current time in milliseconds
+     * @param completed Output: the whole snapshot, when this was its last missing chunk
+     * @return true if the snapshot is complete
+     */
+    bool addChunk(const LanHubProtocol::PacketHeader& header, const uint8_t* payload, size_t payloadLength,
+                  unsigned long now, String& completed);
+
+    /**
+     * @brief Forget partial snapshots that stopped arriving
+     * @param now Current time in milliseconds
+     */
+    void prune(unsigned long now);
+
+    /**
+     * @brief Number of snapshots partially received
+     */
+    size_t pending() const { return _entries.size(); }
+
+    static constexpr unsigned long TIMEOUT = 5000;   ///< Drop partial snapshots after this long
+
+private:
+    /**
+     * @struct Entry
+     * @brief Chunks of a snapshot received so far
+     */
+    struct Entry {
+        uint32_t seq;
+        uint8_t received;
+        std::vector<String> chunks;
+        unsigned long startedAt;
+    };
+
+    std::map<String, Entry> _entries;   ///< Snapshots being received, by insight ID
+};
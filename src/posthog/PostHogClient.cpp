@@ -1,6 +1,7 @@
 #include "PostHogClient.h"
 #include "../ConfigManager.h"
 #include "../AsyncHTTPClient.h"
+#include <algorithm>
 
 
 
@@ -8,22 +9,40 @@ PostHogClient::PostHogClient(ConfigManager& config, EventQueue& eventQueue)
     : _config(config)
     , _eventQueue(eventQueue)
     , _asyncHttpClient(std::make_unique<AsyncHTTPClient>(eventQueue))
+    , _refresh_cursor(0)
     , has_active_request(false)
-    , last_refresh_check(0) {
+    , last_refresh_check(0)
+    , next_refresh_slot(millis() + computeRefreshPhaseOffset())
+    , next_refresh_due(next_refresh_slot)
+    , _pendingMutex(xSemaphoreCreateMutex())
+    , _lanHub(std::make_unique<LanHub>(config.getHubRole()))
+    , _fetchMode(FetchMode::PROJECTED_QUERY)
+    , _apiConfigChanged(false) {
     // Configure secure client for HTTPS
     _secureClient.setInsecure(); // TODO: get proper cert baked into the firmware to verify these connections
     _http.setReuse(true);
     
-    // Subscribe to force refresh events
-    _eventQueue.subscribe([this](const Event& event) {
-        if (event.type == EventType::INSIGHT_FORCE_REFRESH) {
-            this->requestInsightData(event.insightId, true);
-        }
+    _lanHub->setSnapshotHandler([this](const String& insight_id, const String& json) {
+        this->handleHubSnapshot(insight_id, json);
+    });
+    _lanHub->setRequestHandler([this](const String& insight_id, bool forceRefresh) {
+        this->handleFollowerRequest(insight_id, forceRefresh);
     });
+    
+    // Subscribe to force refresh and push events
+    _subscriptions.push_back(_eventQueue.subscribe(EventType::INSIGHT_FORCE_REFRESH, [this](const Event& event) {
+        this->requestInsightData(event.insightId, true);
+    }));
+    _subscriptions.push_back(_eventQueue.subscribe(EventType::INSIGHT_DATA_PUSHED, [this](const Event& event) {
+        this->handlePushedInsight(event.insightId, event.jsonData);
+    }));
+    _subscriptions.push_back(_eventQueue.subscribe(EventType::API_CONFIG_CHANGED, [this](const Event& event) {
+        _apiConfigChanged = true;
+    }));
 }
 
-String PostHogClient::buildBaseUrl() const {
-    return "https://" + _config.getRegion() + ".posthog.com/api/projects/";
+String PostHogClient::buildBaseUrl(const ConfigManager::ApiConfig& api) const {
+    return "https://" + api.region + ".posthog.com/api/projects/";
 }
 
 void PostHogClient::requestInsightData(const String& insight_id, bool forceRefresh) {
@@ -37,26 +56,133 @@ void PostHogClient::requestInsightData(const String& insight_id, bool forceRefre
         Serial.printf("[PostHogClient] Showing cached data for %s\n", insight_id.c_str());
         publishInsightDataEvent(insight_id, cachedData);
         
-        // Still fetch fresh data in background
-        makeAsyncInsightRequest(insight_id, false);
+        // Still fetch fresh data in background, unless a relay is pushing it
+        if (!isReceivingPushes(insight_id)) {
+            enqueueInsightRequest(insight_id, false);
+        }
     } else {
         // No cache or force refresh - show loading state and fetch
         _eventQueue.publishEvent(EventType::INSIGHT_NETWORK_STATE_CHANGED, insight_id, "loading");
-        makeAsyncInsightRequest(insight_id, forceRefresh);
+        enqueueInsightRequest(insight_id, forceRefresh);
+    }
+}
+
+void PostHogClient::setFocusedInsight(const String& insight_id) {
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) == pdTRUE) {
+        _focused_insight = insight_id;
+        xSemaphoreGive(_pendingMutex);
+    }
+}
+
+void PostHogClient::enqueueInsightRequest(const String& insight_id, bool forceRefresh) {
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    // Merge with an existing pending request for the same insight
+    for (auto& pending : _pending_requests) {
+        if (pending.insight_id == insight_id) {
+            pending.force_refresh = pending.force_refresh || forceRefresh;
+            xSemaphoreGive(_pendingMutex);
+            return;
+        }
+    }
+    
+    _pending_requests.push_back({insight_id, forceRefresh});
+    
+    // Over capacity: shed the least important request rather than let the backlog grow
+    if (_pending_requests.size() > MAX_PENDING_REQUESTS) {
+        auto lowest = std::min_element(_pending_requests.begin(), _pending_requests.end(),
+            [this](const PendingRequest& a, const PendingRequest& b) {
+                return requestPriority(a) < requestPriority(b);
+            });
+        Serial.printf("[PostHogClient] Request backlog full, shedding %s\n", lowest->insight_id.c_str());
+        _pending_requests.erase(lowest);
+    }
+    
+    xSemaphoreGive(_pendingMutex);
+}
+
+int PostHogClient::requestPriority(const PendingRequest& request) const {
+    int priority = 0;
+    if (!_focused_insight.isEmpty() && request.insight_id == _focused_insight) {
+        priority += 2;
+    }
+    if (request.force_refresh) {
+        priority += 1;
+    }
+    return priority;
+}
+
+void PostHogClient::dispatchPendingRequests() {
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    if (_rateLimiter.isPaused()) {
+        // Don't retry into the limit: drop background refreshes for off-screen cards,
+        // the round-robin refresh will pick them up again once the pause is over
+        auto shed = std::remove_if(_pending_requests.begin(), _pending_requests.end(),
+            [this](const PendingRequest& request) {
+                return requestPriority(request) == 0;
+            });
+        if (shed != _pending_requests.end()) {
+            Serial.printf("[PostHogClient] Rate limited for %lu ms, shedding %u background requests\n",
+                          _rateLimiter.pauseRemaining(), (unsigned)(_pending_requests.end() - shed));
+            _pending_requests.erase(shed, _pending_requests.end());
+        }
+        xSemaphoreGive(_pendingMutex);
+        return;
+    }
+    
+    std::vector<PendingRequest> ready;
+    while (!_pending_requests.empty() && _rateLimiter.tryAcquire()) {
+        auto highest = std::max_element(_pending_requests.begin(), _pending_requests.end(),
+            [this](const PendingRequest& a, const PendingRequest& b) {
+                return requestPriority(a) < requestPriority(b);
+            });
+        ready.push_back(*highest);
+        _pending_requests.erase(highest);
+    }
+    
+    xSemaphoreGive(_pendingMutex);
+    
+    for (const auto& request : ready) {
+        if (_lanHub->isFollower()) {
+            // The hub answers on the multicast group, handleHubSnapshot picks it up
+            _lanHub->requestInsight(request.insight_id, request.force_refresh);
+        } else {
+            makeAsyncInsightRequest(request.insight_id, request.force_refresh);
+        }
     }
 }
 
 bool PostHogClient::isReady() const {
-    return SystemController::isSystemFullyReady() && 
-           _config.getTeamId() != ConfigManager::NO_TEAM_ID && 
-           _config.getApiKey().length() > 0;
+    if (_lanHub->isFollower()) {
+        return SystemController::getWifiState() == WifiState::CONNECTED;
+    }
+    return SystemController::isSystemFullyReady() && _config.getApiConfig()->isComplete();
 }
 
 void PostHogClient::process() {
+    // Nothing built for the old team, key or region may be used with the new one
+    if (_apiConfigChanged.exchange(false)) {
+        resetForNewApiConfig();
+    }
+
     if (!isReady()) {
         return;
     }
 
+    // Exchange snapshots and requests with the rest of the LAN
+    _lanHub->process();
+
+    // Publish data pushed by a relay since the last pass
+    publishPushedInsights();
+
+    // Release queued requests as rate limiter tokens allow
+    dispatchPendingRequests();
+
     // Process async HTTP client
     _asyncHttpClient->process();
 
@@ -65,14 +191,52 @@ void PostHogClient::process() {
         processQueue();
     }
 
-    // Check for needed refreshes
+    // Check for needed refreshes on this device's phase of the interval
     unsigned long now = millis();
-    if (now - last_refresh_check >= REFRESH_INTERVAL) {
+    if ((long)(now - next_refresh_due) >= 0) {
         last_refresh_check = now;
+        scheduleNextRefresh();
         checkRefreshes();
     }
 }
 
+void PostHogClient::resetForNewApiConfig() {
+    Serial.println("[PostHogClient] API settings changed, dropping cached data and queued requests");
+    
+    _asyncHttpClient->cancelAllRequests();
+    request_queue = std::queue<QueuedRequest>();
+    _insightCache.clear();
+    _cacheTimestamps.clear();
+    _projections.clear();
+    _follower_insights.clear();
+    _rateLimiter = RateLimiter();
+    
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) == pdTRUE) {
+        _pending_requests.clear();
+        _pushed_insights.clear();
+        _lastPushTimes.clear();
+        xSemaphoreGive(_pendingMutex);
+    }
+    
+    // Cards keep their insights; fetch them again with the new settings
+    for (const String& insight_id : requested_insights) {
+        enqueueInsightRequest(insight_id, false);
+    }
+}
+
+unsigned long PostHogClient::computeRefreshPhaseOffset() {
+    unsigned long offset = RefreshSchedule::phaseOffset(ESP.getEfuseMac(), REFRESH_INTERVAL);
+    Serial.printf("[PostHogClient] Refresh phase offset: %lu ms\n", offset);
+    return offset;
+}
+
+void PostHogClient::scheduleNextRefresh() {
+    RefreshSchedule::Slot next = RefreshSchedule::next(next_refresh_slot, millis(), REFRESH_INTERVAL,
+                                                       REFRESH_JITTER, random);
+    next_refresh_slot = next.slot;
+    next_refresh_due = next.due;
+}
+
 void PostHogClient::onSystemStateChange(SystemState state) {
     if (!SystemController::isSystemFullyReady() == false) {
         // Clear any active request when system becomes not ready
@@ -116,47 +280,39 @@ void PostHogClient::processQueue() {
 }
 
 void PostHogClient::checkRefreshes() {
-    if (requested_insights.empty()) {
+    size_t total = requested_insights.size() + _follower_insights.size();
+    if (total == 0) {
         return;
     }
     
-    // Pick one insight to refresh
-    String refresh_id;
+    // Round-robin over this device's cards, then the insights followers asked for
+    size_t index = _refresh_cursor++ % total;
+    String refresh_id = index < requested_insights.size()
+        ? *std::next(requested_insights.begin(), index)
+        : _follower_insights[index - requested_insights.size()];
     
-    // This cycles through insights in a round-robin fashion since sets are ordered
-    static auto it = requested_insights.begin();
-    if (it == requested_insights.end()) {
-        it = requested_insights.begin();
-    }
-    
-    if (it != requested_insights.end()) {
-        refresh_id = *it;
-        ++it;
-    } else {
-        // Reset if we're at the end
-        it = requested_insights.begin();
-        if (it != requested_insights.end()) {
-            refresh_id = *it;
-            ++it;
-        }
+    if (!refresh_id.isEmpty() && isReceivingPushes(refresh_id)) {
+        // Pushes keep this one fresh; give its slot back to the radio
+        return;
     }
     
     if (!refresh_id.isEmpty()) {
         // Use async request for automatic refreshes (non-blocking)
         Serial.printf("[PostHogClient] Auto-refreshing insight %s\\n", refresh_id.c_str());
-        makeAsyncInsightRequest(refresh_id, false); // Use cache first
+        enqueueInsightRequest(refresh_id, false); // Use cache first
     }
 }
 
 String PostHogClient::buildInsightUrl(const String& insight_id, const char* refresh_mode) const {
-    String url = buildBaseUrl();
-    url += String(_config.getTeamId());
+    ConfigManager::ApiConfigPtr api = _config.getApiConfig();
+    String url = buildBaseUrl(*api);
+    url += api->teamId;
     url += "/insights/?refresh=";
     url += refresh_mode;
     url += "&short_id=";
     url += insight_id;
     url += "&personal_api_key=";
-    url += _config.getApiKey();
+    url += api->apiKey;
     return url;
 }
 
@@ -306,12 +462,145 @@ void PostHogClient::publishInsightDataEvent(const String& insight_id, const Stri
     Serial.printf("Published raw JSON data for %s\n", insight_id.c_str());
 }
 
+void PostHogClient::handleHubSnapshot(const String& insight_id, const String& json) {
+    // Snapshots for cards this device doesn't show are still cached, they're cheap
+    publishInsightDataEvent(insight_id, json);
+    _eventQueue.publishEvent(EventType::INSIGHT_NETWORK_STATE_CHANGED, insight_id, "success");
+}
+
+void PostHogClient::handlePushedInsight(const String& insight_id, const String& json) {
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    // Only the newest push for an insight is worth publishing
+    auto queued = std::find_if(_pushed_insights.begin(), _pushed_insights.end(),
+        [&insight_id](const PushedInsight& pushed) {
+            return pushed.insight_id == insight_id;
+        });
+    if (queued != _pushed_insights.end()) {
+        _pushed_insights.erase(queued);
+    }
+    _pushed_insights.push_back({insight_id, json});
+    
+    // Bound what a busy or misbehaving relay can pile up before process() runs
+    size_t bytes = 0;
+    for (const PushedInsight& pushed : _pushed_insights) {
+        bytes += pushed.json.length();
+    }
+    while (_pushed_insights.size() > MAX_QUEUED_PUSHES || bytes > MAX_QUEUED_PUSH_BYTES) {
+        Serial.printf("[PostHogClient] Push backlog full, dropping push for %s\n",
+                      _pushed_insights.front().insight_id.c_str());
+        bytes -= _pushed_insights.front().json.length();
+        _pushed_insights.erase(_pushed_insights.begin());
+    }
+    
+    xSemaphoreGive(_pendingMutex);
+}
+
+void PostHogClient::publishPushedInsights() {
+    std::vector<PushedInsight> pushed;
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    pushed.swap(_pushed_insights);
+    xSemaphoreGive(_pendingMutex);
+    
+    // A relay may push anything; keep what a card shows or a follower asked for
+    pushed.erase(std::remove_if(pushed.begin(), pushed.end(),
+        [this](const PushedInsight& insight) {
+            if (isKnownInsight(insight.insight_id)) {
+                return false;
+            }
+            Serial.printf("[PostHogClient] Ignoring push for %s, nothing shows it\n", insight.insight_id.c_str());
+            return true;
+        }), pushed.end());
+    
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    unsigned long now = millis();
+    for (auto it = _lastPushTimes.begin(); it != _lastPushTimes.end();) {
+        if (now - it->second >= PUSH_BACKOFF) {
+            it = _lastPushTimes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const PushedInsight& insight : pushed) {
+        const String& insight_id = insight.insight_id;
+        _lastPushTimes[insight_id] = now;
+        
+        // Anything still waiting to be polled is now redundant
+        _pending_requests.erase(std::remove_if(_pending_requests.begin(), _pending_requests.end(),
+            [&insight_id](const PendingRequest& request) {
+                return request.insight_id == insight_id && !request.force_refresh;
+            }), _pending_requests.end());
+    }
+    xSemaphoreGive(_pendingMutex);
+    
+    for (const PushedInsight& insight : pushed) {
+        publishInsightDataEvent(insight.insight_id, insight.json);
+        _eventQueue.publishEvent(EventType::INSIGHT_NETWORK_STATE_CHANGED, insight.insight_id, "success");
+        
+        // A hub passes pushed data on like anything it fetched
+        _lanHub->publishSnapshot(insight.insight_id, insight.json);
+    }
+}
+
+bool PostHogClient::isKnownInsight(const String& insight_id) const {
+    return requested_insights.count(insight_id) > 0 ||
+           std::find(_follower_insights.begin(), _follower_insights.end(), insight_id) != _follower_insights.end();
+}
+
+bool PostHogClient::isReceivingPushes(const String& insight_id) {
+    bool receiving = false;
+    if (xSemaphoreTake(_pendingMutex, portMAX_DELAY) == pdTRUE) {
+        auto it = _lastPushTimes.find(insight_id);
+        receiving = it != _lastPushTimes.end() && millis() - it->second < PUSH_BACKOFF;
+        xSemaphoreGive(_pendingMutex);
+    }
+    return receiving;
+}
+
+void PostHogClient::handleFollowerRequest(const String& insight_id, bool forceRefresh) {
+    if (insight_id.isEmpty() || insight_id.length() > LanHub::MAX_INSIGHT_ID_LENGTH) {
+        return;
+    }
+    Serial.printf("[PostHogClient] Follower requested %s\n", insight_id.c_str());
+    
+    if (requested_insights.count(insight_id) == 0) {
+        // Most recently requested last; the longest-unrequested insight leaves the rotation first
+        auto known = std::find(_follower_insights.begin(), _follower_insights.end(), insight_id);
+        if (known != _follower_insights.end()) {
+            _follower_insights.erase(known);
+        } else if (_follower_insights.size() >= MAX_FOLLOWER_INSIGHTS) {
+            Serial.printf("[PostHogClient] Follower insights full, no longer refreshing %s\n",
+                          _follower_insights.front().c_str());
+            _follower_insights.erase(_follower_insights.begin());
+        }
+        _follower_insights.push_back(insight_id);
+    }
+    
+    enqueueInsightRequest(insight_id, forceRefresh);
+}
+
 void PostHogClient::makeAsyncInsightRequest(const String& insight_id, bool forceRefresh) {
     if (!isReady() || WiFi.status() != WL_CONNECTED) {
         handleInsightError(insight_id, "System not ready or WiFi disconnected", 0);
         return;
     }
     
+    if (!forceRefresh && _fetchMode == FetchMode::PROJECTED_QUERY) {
+        auto projection = _projections.find(insight_id);
+        if (projection != _projections.end() &&
+            projection->second.shape != InsightProjection::Shape::NONE &&
+            millis() - projection->second.createdAt < InsightProjection::TEMPLATE_MAX_AGE) {
+            makeAsyncProjectedRequest(insight_id, projection->second);
+            return;
+        }
+    }
+    
     String url = buildInsightUrl(insight_id, forceRefresh ? "blocking" : "force_cache");
     
     AsyncHTTPClient::RequestConfig config;
@@ -320,9 +609,14 @@ void PostHogClient::makeAsyncInsightRequest(const String& insight_id, bool force
     config.timeout = 30000; // 30 seconds
     config.maxRetries = 3;
     
+    // Let the shared limiter see quota and Retry-After headers
+    config.onHeaders = [this](const String& headers, int statusCode) {
+        _rateLimiter.onResponse(statusCode, headers);
+    };
+    
     // Success callback
-    config.onSuccess = [this, insight_id](const String& response, int statusCode) {
-        this->handleInsightSuccess(insight_id, response, statusCode);
+    config.onSuccess = [this, insight_id, forceRefresh](const String& response, int statusCode) {
+        this->handleInsightSuccess(insight_id, forceRefresh, response, statusCode);
     };
     
     // Error callback
@@ -331,7 +625,7 @@ void PostHogClient::makeAsyncInsightRequest(const String& insight_id, bool force
     };
     
     // Make the async request
-    String requestId = _asyncHttpClient->request(config);
+    String requestId = _asyncHttpClient->request(std::move(config));
     if (requestId.isEmpty()) {
         handleInsightError(insight_id, "Failed to queue HTTP request", 0);
     } else {
@@ -340,7 +634,8 @@ void PostHogClient::makeAsyncInsightRequest(const String& insight_id, bool force
     }
 }
 
-void PostHogClient::handleInsightSuccess(const String& insight_id, const String& data, int statusCode) {
+void PostHogClient::handleInsightSuccess(const String& insight_id, bool forceRefresh, const String& data,
+                                         int statusCode) {
     // This is called on the UI thread via AsyncHTTPClient
     Serial.printf("[PostHogClient] Async request succeeded for %s (HTTP %d, %d bytes)\\n", 
                   insight_id.c_str(), statusCode, data.length());
@@ -349,18 +644,105 @@ void PostHogClient::handleInsightSuccess(const String& insight_id, const String&
         // Check if we need to retry with blocking refresh
         if (data.indexOf("\\\"result\\\":null") >= 0 || data.indexOf("\\\"result\\\":[]") >= 0) {
             Serial.printf("[PostHogClient] Cache miss for %s, retrying with blocking refresh\\n", insight_id.c_str());
-            makeAsyncInsightRequest(insight_id, true); // Force refresh
+            enqueueInsightRequest(insight_id, true); // Force refresh
             return;
         }
         
+        // Remember how to fetch just the rendered fields next time
+        if (_fetchMode == FetchMode::PROJECTED_QUERY) {
+            auto projection = _projections.find(insight_id);
+            bool rejected = projection != _projections.end() &&
+                            projection->second.shape == InsightProjection::Shape::NONE &&
+                            millis() - projection->second.createdAt < InsightProjection::TEMPLATE_MAX_AGE;
+            InsightProjection::Template tmpl;
+            if (!rejected && InsightProjection::extractTemplate(data, tmpl)) {
+                _projections[insight_id] = tmpl;
+            } else if (!rejected) {
+                _projections.erase(insight_id);
+            }
+        }
+        
         // Success - publish data and update UI state
         publishInsightDataEvent(insight_id, data);
         _eventQueue.publishEvent(EventType::INSIGHT_NETWORK_STATE_CHANGED, insight_id, "success");
+        
+        // Followers render this fetch instead of making their own
+        _lanHub->publishSnapshot(insight_id, data);
+    } else if (statusCode == 429) {
+        // The limiter has already paused from the response headers; wait our turn
+        // instead of surfacing an error and keep showing the current data
+        Serial.printf("[PostHogClient] Rate limited fetching %s, re-queuing\n", insight_id.c_str());
+        enqueueInsightRequest(insight_id, forceRefresh);
     } else {
         handleInsightError(insight_id, "HTTP " + String(statusCode), statusCode);
     }
 }
 
+void PostHogClient::makeAsyncProjectedRequest(const String& insight_id, const InsightProjection::Template& tmpl) {
+    ConfigManager::ApiConfigPtr api = _config.getApiConfig();
+    AsyncHTTPClient::RequestConfig config;
+    config.url = buildBaseUrl(*api) + String(api->teamId) + "/query/";
+    config.method = AsyncHTTPClient::Method::POST;
+    config.headers = "Authorization: Bearer " + api->apiKey + "\r\n"; // AsyncHTTPClient adds Content-Type for the body
+    // "blocking" only recalculates when the cached result is stale, so no cache-miss retry is needed
+    config.body = InsightProjection::buildRequestBody(tmpl, "blocking");
+    config.timeout = 30000; // 30 seconds
+    config.maxRetries = 3;
+    
+    config.onHeaders = [this](const String& headers, int statusCode) {
+        _rateLimiter.onResponse(statusCode, headers);
+    };
+    
+    config.onSuccess = [this, insight_id, tmpl](const String& response, int statusCode) {
+        this->handleProjectedSuccess(insight_id, tmpl, response, statusCode);
+    };
+    
+    config.onError = [this, insight_id](const String& error, int statusCode) {
+        this->handleInsightError(insight_id, error, statusCode);
+    };
+    
+    String requestId = _asyncHttpClient->request(std::move(config));
+    if (requestId.isEmpty()) {
+        handleInsightError(insight_id, "Failed to queue HTTP request", 0);
+    } else {
+        Serial.printf("[PostHogClient] Started projected request %s for insight %s\n", 
+                      requestId.c_str(), insight_id.c_str());
+    }
+}
+
+void PostHogClient::handleProjectedSuccess(const String& insight_id, const InsightProjection::Template& tmpl,
+                                           const String& data, int statusCode) {
+    if (statusCode == 429) {
+        Serial.printf("[PostHogClient] Rate limited fetching %s, re-queuing\n", insight_id.c_str());
+        enqueueInsightRequest(insight_id, false); // Forced refreshes always take the full fetch path
+        return;
+    }
+    
+    String snapshot;
+    if (statusCode == 200 && InsightProjection::buildSnapshot(tmpl, data, snapshot)) {
+        Serial.printf("[PostHogClient] Projected fetch for %s: %u bytes down, %u bytes rendered\n",
+                      insight_id.c_str(), data.length(), snapshot.length());
+        publishInsightDataEvent(insight_id, snapshot);
+        _eventQueue.publishEvent(EventType::INSIGHT_NETWORK_STATE_CHANGED, insight_id, "success");
+        _lanHub->publishSnapshot(insight_id, snapshot);
+        return;
+    }
+    
+    // Query rejected or unreadable; the definition may have changed, so re-read it in full
+    Serial.printf("[PostHogClient] Projected fetch for %s failed (HTTP %d), falling back to full fetch\n",
+                  insight_id.c_str(), statusCode);
+    if (statusCode > 0 && statusCode < 500) {
+        // The server won't run our projection, or answers it in a shape we can't read;
+        // stop trying until the template would expire anyway
+        InsightProjection::Template rejected;
+        rejected.createdAt = millis();
+        _projections[insight_id] = rejected;
+    } else {
+        _projections.erase(insight_id);
+    }
+    enqueueInsightRequest(insight_id, false);
+}
+
 void PostHogClient::handleInsightError(const String& insight_id, const String& error, int statusCode) {
     // This is called on the UI thread via AsyncHTTPClient
     Serial.printf("[PostHogClient] Async request failed for %s: %s (HTTP %d)\\n", 
@@ -9,10 +9,15 @@
 #include <set>
 #include <memory>
 #include <map>
+#include <atomic>
 #include "../ConfigManager.h"
 #include "SystemController.h"
 #include "EventQueue.h"
 #include "parsers/InsightParser.h"
+#include "RateLimiter.h"
+#include "RefreshSchedule.h"
+#include "LanHub.h"
+#include "InsightProjection.h"
 #include "../AsyncHTTPClient.h"
 
 /**
@@ -25,9 +30,22 @@
  * - Thread-safe operation with event queue
  * - Configurable retry and refresh intervals
  * - Support for multiple insight types
+ * - Shared token bucket rate limiting with priority-ordered request shedding
+ * - Optional LAN hub role: one device fetches, followers receive multicast snapshots
+ * - Polling backs off for insights a local relay is pushing
+ * - Projected refreshes through the query API that download only rendered fields
  */
 class PostHogClient {
 public:
+    /**
+     * @enum FetchMode
+     * @brief How insight refreshes are fetched
+     */
+    enum class FetchMode {
+        FULL_INSIGHT,     ///< Always download the full insight object
+        PROJECTED_QUERY   ///< After the first full fetch, query only the rendered fields
+    };
+    
     /**
      * @brief Constructor
      * 
@@ -64,6 +82,8 @@ public:
      * @brief Check if client is ready for operation
      * 
      * @return true if configured and connected
+     * 
+     * Followers only need WiFi; they never talk to PostHog directly.
      */
     bool isReady() const;
     
@@ -78,6 +98,25 @@ public:
      */
     void process();
     
+    /**
+     * @brief Mark the insight currently shown on screen
+     * 
+     * @param insight_id ID of the visible insight, empty if no insight card is visible
+     * 
+     * Requests for the focused insight are dispatched first and are never
+     * shed while the rate limiter is holding requests back.
+     */
+    void setFocusedInsight(const String& insight_id);
+    
+    /**
+     * @brief Choose how insight refreshes are fetched
+     * @param mode Fetch mode, PROJECTED_QUERY by default
+     * 
+     * Forced refreshes always use the full insight endpoint so the
+     * insight's definition is re-read along with fresh data.
+     */
+    void setFetchMode(FetchMode mode) { _fetchMode = mode; }
+    
 private:
     /**
      * @struct QueuedRequest
@@ -89,37 +128,96 @@ private:
         bool force_refresh;    ///< Force recalculation instead of cache
     };
     
+    /**
+     * @struct PushedInsight
+     * @brief Insight data pushed by a relay, waiting for the insight task
+     */
+    struct PushedInsight {
+        String insight_id;     ///< ID of pushed insight
+        String json;           ///< Insight JSON
+    };
+    
+    /**
+     * @struct PendingRequest
+     * @brief Insight fetch waiting for a rate limiter token
+     */
+    struct PendingRequest {
+        String insight_id;     ///< ID of insight to fetch
+        bool force_refresh;    ///< Force recalculation instead of cache
+    };
+    
     // Configuration
     ConfigManager& _config;         ///< Configuration storage
     EventQueue& _eventQueue;        ///< Event system
+    std::vector<EventSubscription> _subscriptions;  ///< Refresh and push handlers
     
     // Async network management
     std::unique_ptr<AsyncHTTPClient> _asyncHttpClient; ///< Truly async HTTP client
     
     // Request tracking
-    std::set<String> requested_insights;  ///< All known insight IDs
+    std::set<String> requested_insights;  ///< Insight IDs this device's cards show
+    std::vector<String> _follower_insights; ///< Hub: insight IDs followers asked for, least recently asked first
+    size_t _refresh_cursor;                ///< Position in the refresh rotation
     std::queue<QueuedRequest> request_queue; ///< Queue of pending requests (legacy)
     bool has_active_request;               ///< Request in progress flag (legacy)
     WiFiClientSecure _secureClient;        ///< Secure WiFi client for HTTPS
     HTTPClient _http;                      ///< HTTP client instance
     unsigned long last_refresh_check;       ///< Last refresh timestamp
+    unsigned long next_refresh_slot;        ///< Nominal time of the next refresh, before jitter
+    unsigned long next_refresh_due;         ///< Jittered time the next refresh fires
     
     // Data caching for progressive loading
     std::map<String, String> _insightCache; ///< Cached insight data
     std::map<String, unsigned long> _cacheTimestamps; ///< Cache timestamps
     
+    // Rate limiting
+    RateLimiter _rateLimiter;                       ///< Token bucket shared by all cards
+    std::vector<PendingRequest> _pending_requests;  ///< Requests waiting for a token
+    String _focused_insight;                        ///< Insight currently on screen
+    SemaphoreHandle_t _pendingMutex;                ///< Guards pending requests and focus
+    
+    // LAN sharing
+    std::unique_ptr<LanHub> _lanHub;                ///< Multicast link to hub or followers
+    
+    // Projected fetches
+    FetchMode _fetchMode;                                         ///< Full or projected refreshes
+    std::map<String, InsightProjection::Template> _projections;  ///< Query templates from full fetches, NONE if rejected
+    
+    // Push ingestion
+    std::map<String, unsigned long> _lastPushTimes; ///< When each known insight was last pushed, within PUSH_BACKOFF; guarded by _pendingMutex
+    std::vector<PushedInsight> _pushed_insights;    ///< Pushes not yet published, guarded by _pendingMutex
+    
+    // API settings
+    std::atomic<bool> _apiConfigChanged;            ///< Set by API_CONFIG_CHANGED, handled in process()
+    
     // Constants
     static const char* BASE_URL;                        ///< PostHog API base URL
     static const unsigned long REFRESH_INTERVAL = 30000; ///< Refresh every 30s
+    static const unsigned long REFRESH_JITTER = 3000;    ///< Max random delay added to each refresh
     static const uint8_t MAX_RETRIES = 3;              ///< Max retry attempts
     static const unsigned long RETRY_DELAY = 1000;      ///< Delay between retries
+    static const size_t MAX_PENDING_REQUESTS = 8;       ///< Pending requests kept before shedding
+    static const unsigned long PUSH_BACKOFF = 5 * 60 * 1000; ///< Skip polling insights pushed this recently
+    static const size_t MAX_FOLLOWER_INSIGHTS = 32;     ///< Follower-requested insights kept in the refresh rotation
+    static const size_t MAX_QUEUED_PUSHES = 8;          ///< Pushes waiting for process() before the oldest is dropped
+    static const size_t MAX_QUEUED_PUSH_BYTES = 128 * 1024; ///< Total JSON waiting for process() before the oldest is dropped
     
 
 
         /**
      * @brief Build Base API URL based on project region
+     * @param api API settings snapshot the rest of the request is built from
+     */
+    String buildBaseUrl(const ConfigManager::ApiConfig& api) const;
+    
+    /**
+     * @brief Drop everything built for the previous API settings (insight task)
+     * 
+     * Cancels in-flight fetches, clears cached data, projections, pushes and
+     * queued requests, restarts the rate limiter, then refetches every known
+     * insight with the new settings.
      */
-    String buildBaseUrl() const;
+    void resetForNewApiConfig();
 
     /**
      * @brief Handle system state changes
@@ -134,10 +232,29 @@ private:
      */
     void processQueue();
     
+    /**
+     * @brief Derive this device's refresh phase from its MAC address
+     * @return Offset in [0, REFRESH_INTERVAL) that is stable across reboots
+     * 
+     * Devices sharing a team and API key usually boot together. Hashing the
+     * MAC spreads their refreshes across the interval instead of firing in lockstep.
+     */
+    static unsigned long computeRefreshPhaseOffset();
+    
+    /**
+     * @brief Advance the refresh schedule to the next slot
+     * 
+     * Slots are REFRESH_INTERVAL apart on a fixed grid; each firing time adds
+     * up to REFRESH_JITTER of random delay so that devices whose MACs hash to
+     * nearby phases still drift apart. Jitter never accumulates across cycles.
+     */
+    void scheduleNextRefresh();
+    
     /**
      * @brief Check if insights need refreshing
      * 
-     * Queues refresh requests for insights older than REFRESH_INTERVAL.
+     * Queues a refresh for the next insight in the rotation: this device's
+     * cards, then the insights followers asked for.
      */
     void checkRefreshes();
     
@@ -163,6 +280,84 @@ private:
     // Event-related methods
     void publishInsightDataEvent(const String& insight_id, const String& response);
     
+    /**
+     * @brief Handle a snapshot multicast by the hub (follower)
+     * @param insight_id ID of insight
+     * @param json Compact insight JSON
+     */
+    void handleHubSnapshot(const String& insight_id, const String& json);
+    
+    /**
+     * @brief Handle a follower asking for an insight the hub has no fresh snapshot of (hub)
+     * @param insight_id ID of insight
+     * @param forceRefresh Whether to force refresh
+     * 
+     * The insight joins this device's refresh rotation so followers keep receiving updates.
+     * At most MAX_FOLLOWER_INSIGHTS are kept; the one followers asked for least
+     * recently is dropped to make room. IDs longer than LanHub::MAX_INSIGHT_ID_LENGTH
+     * are ignored.
+     */
+    void handleFollowerRequest(const String& insight_id, bool forceRefresh);
+    
+    /**
+     * @brief Handle insight data pushed to the portal by a local relay
+     * @param insight_id ID of insight
+     * @param json Insight JSON
+     * 
+     * Runs on the event queue task, so it only queues the data; process()
+     * publishes it. At most MAX_QUEUED_PUSHES pushes totalling
+     * MAX_QUEUED_PUSH_BYTES wait at once; the oldest are dropped first.
+     */
+    void handlePushedInsight(const String& insight_id, const String& json);
+    
+    /**
+     * @brief Cache, publish and relay queued pushes (insight task)
+     * 
+     * Pushes for insights no card shows, and no follower asked for, are
+     * dropped. Polling for a pushed insight backs off until pushes stop
+     * for PUSH_BACKOFF.
+     */
+    void publishPushedInsights();
+    
+    /**
+     * @brief Check whether a card or a follower wants an insight (insight task)
+     * @param insight_id ID of insight
+     */
+    bool isKnownInsight(const String& insight_id) const;
+    
+    /**
+     * @brief Check whether an insight is being kept fresh by pushes
+     * @param insight_id ID of insight
+     * @return true if pushed within PUSH_BACKOFF
+     */
+    bool isReceivingPushes(const String& insight_id);
+    
+    /**
+     * @brief Queue an insight fetch behind the rate limiter
+     * @param insight_id ID of insight to fetch
+     * @param forceRefresh Whether to force refresh
+     * 
+     * Duplicate requests for the same insight are merged. Safe to call from any task.
+     */
+    void enqueueInsightRequest(const String& insight_id, bool forceRefresh);
+    
+    /**
+     * @brief Dispatch pending requests while tokens are available
+     * 
+     * Highest priority requests go first. While the limiter is paused,
+     * background refreshes for off-screen cards are shed instead of waiting.
+     */
+    void dispatchPendingRequests();
+    
+    /**
+     * @brief Rank a pending request for dispatch and shedding
+     * @param request Pending request
+     * @return Higher value means more important (focused card, then forced refresh)
+     * 
+     * Caller must hold _pendingMutex.
+     */
+    int requestPriority(const PendingRequest& request) const;
+    
     /**
      * @brief Make async insight request
      * @param insight_id ID of insight to fetch
@@ -170,13 +365,36 @@ private:
      */
     void makeAsyncInsightRequest(const String& insight_id, bool forceRefresh);
     
+    /**
+     * @brief Fetch an insight through the query endpoint
+     * @param insight_id ID of insight
+     * @param tmpl Projection template from an earlier full fetch
+     */
+    void makeAsyncProjectedRequest(const String& insight_id, const InsightProjection::Template& tmpl);
+    
+    /**
+     * @brief Handle a query endpoint response for a projected fetch
+     * @param insight_id ID of insight
+     * @param tmpl Projection template the request was built from
+     * @param data Retrieved data
+     * @param statusCode HTTP status code
+     * 
+     * A result with no rows is still a result. Otherwise the insight falls
+     * back to a full fetch: a rejected or unreadable response marks the
+     * template rejected until it would expire, a server error drops it so
+     * the full fetch re-reads the insight definition.
+     */
+    void handleProjectedSuccess(const String& insight_id, const InsightProjection::Template& tmpl,
+                                const String& data, int statusCode);
+    
     /**
      * @brief Handle successful insight data retrieval
      * @param insight_id ID of insight
+     * @param forceRefresh Whether the request asked for recalculation; kept when re-queuing after a 429
      * @param data Retrieved data
      * @param statusCode HTTP status code
      */
-    void handleInsightSuccess(const String& insight_id, const String& data, int statusCode);
+    void handleInsightSuccess(const String& insight_id, bool forceRefresh, const String& data, int statusCode);
     
     /**
      * @brief Handle insight data retrieval error
@@ -0,0 +1,129 @@
+#include "RateLimiter.h"
+#include "../AsyncHTTPClient.h"
+#include <algorithm>
+
+RateLimiter::RateLimiter(uint16_t capacity, unsigned long refillIntervalMs)
+    : _capacity(capacity)
+    , _refillInterval(refillIntervalMs)
+    , _tokens(capacity)
+    , _lastRefill(millis())
+    , _pauseStart(0)
+    , _pauseDuration(0) {
+}
+
+bool RateLimiter::tryAcquire() {
+    if (isPaused()) {
+        return false;
+    }
+
+    refill();
+    if (_tokens == 0) {
+        return false;
+    }
+
+    _tokens--;
+    return true;
+}
+
+bool RateLimiter::isPaused() const {
+    return pauseRemaining() > 0;
+}
+
+unsigned long RateLimiter::pauseRemaining() const {
+    if (_pauseDuration == 0) {
+        return 0;
+    }
+
+    unsigned long elapsed = millis() - _pauseStart;
+    return elapsed >= _pauseDuration ? 0 : _pauseDuration - elapsed;
+}
+
+void RateLimiter::pauseFor(unsigned long durationMs) {
+    durationMs = std::min(durationMs, MAX_PAUSE);
+    if (durationMs <= pauseRemaining()) {
+        return;
+    }
+
+    _pauseStart = millis();
+    _pauseDuration = durationMs;
+
+    // Nothing accrues while the server has asked us to wait
+    _tokens = 0;
+    _lastRefill = _pauseStart + _pauseDuration;
+
+    Serial.printf("[RateLimiter] Pausing requests for %lu ms\n", durationMs);
+}
+
+void RateLimiter::onResponse(int statusCode, const String& headers) {
+    long value = 0;
+
+    if (statusCode == 429 || statusCode == 503) {
+        // Only the delta-seconds form of Retry-After is supported
+        if (readNumericHeader(headers, "Retry-After", value) && value > 0) {
+            pauseFor(static_cast<unsigned long>(value) * 1000UL);
+        } else if (statusCode == 429) {
+            pauseFor(DEFAULT_RETRY_AFTER);
+        }
+        return;
+    }
+
+    bool hasRemaining = readNumericHeader(headers, "X-RateLimit-Remaining", value) ||
+                        readNumericHeader(headers, "RateLimit-Remaining", value);
+    if (!hasRemaining) {
+        return;
+    }
+
+    if (value <= 0) {
+        long reset = 0;
+        bool hasReset = readNumericHeader(headers, "X-RateLimit-Reset", reset) ||
+                        readNumericHeader(headers, "RateLimit-Reset", reset);
+        // Small values are seconds-until-reset; epoch timestamps can't be used without a clock
+        if (hasReset && reset > 0 && reset < 24L * 60 * 60) {
+            pauseFor(static_cast<unsigned long>(reset) * 1000UL);
+        } else {
+            pauseFor(DEFAULT_RETRY_AFTER);
+        }
+    } else {
+        refill();
+        _tokens = std::min<uint16_t>(_tokens, static_cast<uint16_t>(std::min<long>(value, _capacity)));
+    }
+}
+
+uint16_t RateLimiter::availableTokens() {
+    if (isPaused()) {
+        return 0;
+    }
+    refill();
+    return _tokens;
+}
+
+void RateLimiter::refill() {
+    unsigned long now = millis();
+
+    // _lastRefill may sit in the future while a pause is running
+    if (static_cast<long>(now - _lastRefill) < 0) {
+        return;
+    }
+
+    unsigned long elapsed = now - _lastRefill;
+    unsigned long newTokens = elapsed / _refillInterval;
+    if (newTokens == 0) {
+        return;
+    }
+
+    _tokens = static_cast<uint16_t>(std::min<unsigned long>(_capacity, _tokens + newTokens));
+    _lastRefill += newTokens * _refillInterval;
+
+    if (_tokens == _capacity) {
+        _lastRefill = now;
+    }
+}
+
+bool RateLimiter::readNumericHeader(const String& headers, const char* name, long& value) {
+    String headerValue = AsyncHTTPClient::getHeaderValue(headers, name);
+    if (headerValue.isEmpty() || !isDigit(headerValue.charAt(0))) {
+        return false;
+    }
+    value = headerValue.toInt();
+    return true;
+}
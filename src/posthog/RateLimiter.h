@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class RateLimiter
+ * @brief Token bucket guarding outgoing PostHog API requests
+ *
+ * Features:
+ * - Burst capacity with steady refill rate
+ * - Server-driven pauses from 429 responses and Retry-After headers
+ * - Tracks remaining quota advertised by rate-limit headers
+ *
+ * Not thread-safe; owned and driven by PostHogClient on the insight task.
+ */
+class RateLimiter {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Maximum number of tokens (burst size)
+     * @param refillIntervalMs Time to regenerate a single token
+     */
+    RateLimiter(uint16_t capacity = DEFAULT_CAPACITY, unsigned long refillIntervalMs = DEFAULT_REFILL_INTERVAL);
+
+    /**
+     * @brief Take a token if one is available and no pause is active
+     * @return true if the caller may issue a request now
+     */
+    bool tryAcquire();
+
+    /**
+     * @brief Check whether the server asked us to back off
+     * @return true while a server-requested pause is in effect
+     */
+    bool isPaused() const;
+
+    /**
+     * @brief Milliseconds until the current pause ends
+     * @return Remaining pause time, 0 if not paused
+     */
+    unsigned long pauseRemaining() const;
+
+    /**
+     * @brief Stop issuing requests for a period of time
+     * @param durationMs Pause length in milliseconds
+     *
+     * Extends, never shortens, an existing pause.
+     */
+    void pauseFor(unsigned long durationMs);
+
+    /**
+     * @brief Update limiter state from an HTTP response
+     *
+     * @param statusCode HTTP status code of the response
+     * @param headers Raw response header block
+     *
+     * Honours Retry-After on 429/503 and the (X-)RateLimit-Remaining /
+     * (X-)RateLimit-Reset headers when the server provides them.
+     */
+    void onResponse(int statusCode, const String& headers);
+
+    /**
+     * @brief Get number of tokens currently available
+     * @return Whole tokens in the bucket
+     */
+    uint16_t availableTokens();
+
+    static constexpr uint16_t DEFAULT_CAPACITY = 10;                 ///< Burst of requests at boot
+    static constexpr unsigned long DEFAULT_REFILL_INTERVAL = 3000;   ///< One token every 3s (1200/hour)
+    static constexpr unsigned long DEFAULT_RETRY_AFTER = 60000;      ///< Pause when a 429 carries no Retry-After
+    static constexpr unsigned long MAX_PAUSE = 15 * 60 * 1000;       ///< Never trust a pause longer than 15 minutes
+
+private:
+    /**
+     * @brief Add tokens accrued since the last refill
+     */
+    void refill();
+
+    /**
+     * @brief Read a numeric header value
+     * @param headers Raw response header block
+     * @param name Header name (case-insensitive)
+     * @param value Output value
+     * @return true if the header was present and numeric
+     */
+    static bool readNumericHeader(const String& headers, const char* name, long& value);
+
+    uint16_t _capacity;               ///< Bucket size
+    unsigned long _refillInterval;    ///< Milliseconds per token
+    uint16_t _tokens;                 ///< Tokens currently available
+    unsigned long _lastRefill;        ///< Timestamp of last refill
+    unsigned long _pauseStart;        ///< Timestamp the pause began
+    unsigned long _pauseDuration;     ///< Length of the active pause, 0 if none
+};
@@ -0,0 +1,23 @@
+#include "RefreshSchedule.h"
+
+unsigned long RefreshSchedule::phaseOffset(uint64_t mac, unsigned long interval) {
+    // FNV-1a over the six MAC bytes; consecutive MACs land far apart
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        hash ^= (uint8_t)(mac >> (i * 8));
+        hash *= 16777619u;
+    }
+    return hash % interval;
+}
+
+RefreshSchedule::Slot RefreshSchedule::next(unsigned long slot, unsigned long now, unsigned long interval,
+                                            unsigned long jitter, RandomFn random) {
+    do {
+        slot += interval;
+    } while ((long)(now - slot) >= 0);
+
+    Slot next;
+    next.slot = slot;
+    next.due = slot + (jitter > 0 ? random(jitter) : 0);
+    return next;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class RefreshSchedule
+ * @brief Picks when a device refreshes its insights
+ *
+ * Devices sharing a team and API key usually boot together. Each one
+ * refreshes on its own phase of the interval, derived from its MAC, and adds
+ * a little random jitter to every firing so that devices whose MACs hash to
+ * nearby phases still drift apart.
+ *
+ * Pure functions of their arguments, so the spread across a fleet can be
+ * simulated off-device.
+ */
+class RefreshSchedule {
+public:
+    /**
+     * @brief Random number source, called like Arduino's random(howbig)
+     * @return A value in [0, howbig)
+     */
+    typedef long (*RandomFn)(long howbig);
+
+    /**
+     * @struct Slot
+     * @brief One scheduled refresh
+     */
+    struct Slot {
+        unsigned long slot;   ///< Nominal time on the device's grid, before jitter
+        unsigned long due;    ///< Jittered time the refresh fires
+    };
+
+    /**
+     * @brief Derive a device's refresh phase from its MAC address
+     * @param mac Factory MAC, as returned by ESP.getEfuseMac()
+     * @param interval Refresh interval in milliseconds
+     * @return Offset in [0, interval) that is stable across reboots
+     */
+    static unsigned long phaseOffset(uint64_t mac, unsigned long interval);
+
+    /**
+     * @brief Advance to the next slot after now
+     *
+     * @param slot Current nominal slot
+     * @param now Current time
+     * @param interval Refresh interval in milliseconds
+     * @param jitter Maximum random delay added to the slot
+     * @param random Random number source
+     * @return The next slot and its jittered firing time
+     *
+     * Slots stay on a fixed grid: slots missed while the device was busy are
+     * skipped rather than fired in a burst, and jitter never accumulates.
+     */
+    static Slot next(unsigned long slot, unsigned long now, unsigned long interval,
+                     unsigned long jitter, RandomFn random);
+};
@@ -139,6 +139,15 @@ bool InsightParser::isValid() const {
     return valid;
 }
 
+bool InsightParser::serializeSnapshot(String& output) const {
+    if (!valid) {
+        return false;
+    }
+    output = "";
+    serializeJson(doc, output);
+    return output.length() > 0;
+}
+
 // Renamed and made private. All accessors must now use m_insightDataRoot
 bool InsightParser::private_hasNumericCardStructure() const {
     if (!valid) return false;
@@ -140,6 +140,16 @@ public:
      * Should be called before attempting to use any other methods.
      */
     bool isValid() const;
+    
+    /**
+     * @brief Serialize the filtered document as a compact snapshot
+     * @param output String to receive the JSON
+     * @return true if the parser is valid and output was written
+     * 
+     * Only the fields this parser reads survive the filter, so the snapshot is
+     * a small, self-contained insight payload that InsightParser accepts again.
+     */
+    bool serializeSnapshot(String& output) const;
 
     /**
      * @brief Determine visualization type from JSON structure
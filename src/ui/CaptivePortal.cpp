@@ -2,8 +2,10 @@
 #include "ConfigManager.h"
 #include "hardware/WifiInterface.h"
 #include "EventQueue.h"
+#include "TraceBuffer.h"
 #include "OtaManager.h" // Required for OtaManager interaction
 #include "ui/CardController.h" // Required for CardController interaction
+#include "posthog/parsers/InsightParser.h"
 #include "html_portal.h"  // For portal HTML
 #include <ArduinoJson.h>  // For JSON responses
 #include <pgmspace.h> // For PROGMEM
@@ -71,6 +73,7 @@ void CaptivePortal::begin() {
     // New API status endpoint
     // Serial.println("Registering /api/status..."); // DEBUG REMOVED
     _server.on("/api/status", HTTP_GET, std::bind(&CaptivePortal::handleApiStatus, this, std::placeholders::_1));
+    _server.on("/api/trace", HTTP_GET, std::bind(&CaptivePortal::handleApiTrace, this, std::placeholders::_1));
 
     // New async action triggering endpoints
     // Serial.println("Registering /api/actions/start-wifi-scan..."); // DEBUG REMOVED
@@ -95,11 +98,37 @@ void CaptivePortal::begin() {
               std::bind(&CaptivePortal::handleSaveConfiguredCards, this, std::placeholders::_1),
               NULL,
               [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-                  // Store body data as a parameter for later processing
-                  request->_tempObject = malloc(len + 1);
-                  if(request->_tempObject != NULL){
-                      memcpy(request->_tempObject, data, len);
-                      ((char*)request->_tempObject)[len] = 0;
+                  // Store body data as a parameter for later processing; large decks arrive in several chunks
+                  if (total > MAX_CARD_CONFIG_BODY_SIZE) {
+                      return; // Rejected in handleSaveConfiguredCards
+                  }
+                  if (index == 0) {
+                      request->_tempObject = malloc(total + 1);
+                      if (request->_tempObject != NULL) {
+                          ((char*)request->_tempObject)[total] = 0;
+                      }
+                  }
+                  if (request->_tempObject != NULL && index + len <= total) {
+                      memcpy((char*)request->_tempObject + index, data, len);
+                  }
+              });
+
+    // Insight push ingestion; bodies this size arrive in several chunks
+    _server.on("/api/insights/push", HTTP_POST,
+              std::bind(&CaptivePortal::handlePushInsight, this, std::placeholders::_1),
+              NULL,
+              [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+                  if (total > MAX_PUSH_BODY_SIZE) {
+                      return; // Rejected in handlePushInsight
+                  }
+                  if (index == 0) {
+                      request->_tempObject = malloc(total + 1);
+                      if (request->_tempObject != NULL) {
+                          ((char*)request->_tempObject)[total] = 0;
+                      }
+                  }
+                  if (request->_tempObject != NULL && index + len <= total) {
+                      memcpy((char*)request->_tempObject + index, data, len);
                   }
               });
 
@@ -444,6 +473,14 @@ void CaptivePortal::processAsyncOperations() {
                 String teamIdStr = current_queued_action.param1; // Use from QueuedAction
                 String apiKey = current_queued_action.param2;    // Use from QueuedAction
                 String region = current_queued_action.param3;   // Use from QueuedAction
+                String hubRole = current_queued_action.param4;  // Use from QueuedAction
+                String pushToken = current_queued_action.param5;
+                if (!hubRole.isEmpty()) {
+                    _configManager.setHubRole(stringToHubRole(hubRole));
+                }
+                if (!pushToken.isEmpty() && pushToken.indexOf("********") == -1) {
+                    _configManager.setPushToken(pushToken);
+                }
                 if (!teamIdStr.isEmpty()) {
                     _configManager.setTeamId(teamIdStr.toInt());
                     if (!apiKey.isEmpty() && apiKey.indexOf("********") == -1) {
@@ -519,6 +556,18 @@ void CaptivePortal::processAsyncOperations() {
 }
 
 // --- New /api/status endpoint ---
+void CaptivePortal::handleApiTrace(AsyncWebServerRequest *request) {
+    // Snapshot now; the response is generated chunk by chunk as the client reads
+    auto trace = std::make_shared<TraceBuffer::ChromeExport>();
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+        [trace](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return trace->read(buffer, maxLen);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"deskhog-trace.json\"");
+    response->addHeader("Access-Control-Allow-Origin", "*");
+    request->send(response);
+}
+
 void CaptivePortal::handleApiStatus(AsyncWebServerRequest *request) {
     // Serial.println("/api/status HANDLER CALLED"); // Removed to reduce log spam
     // REMOVE SIMPLIFIED TEST BLOCK
@@ -526,7 +575,7 @@ void CaptivePortal::handleApiStatus(AsyncWebServerRequest *request) {
     // return; 
 
     // RESTORE ORIGINAL FULL LOGIC
-    DynamicJsonDocument doc(4096); 
+    DynamicJsonDocument doc(6144); // Room for networks plus event queue histograms
 
     JsonObject portalObj = doc.createNestedObject("portal");
     portalObj["action_in_progress"] = portalActionToString(_action_in_progress);
@@ -579,7 +628,45 @@ void CaptivePortal::handleApiStatus(AsyncWebServerRequest *request) {
     deviceConfigObj["api_key_display"] = apiKey.length() > 0 ? "********" + apiKey.substring(apiKey.length() - 4) : "";
     deviceConfigObj["api_key_present"] = apiKey.length() > 0;
     deviceConfigObj["region"] = _configManager.getRegion();
+    deviceConfigObj["hub_role"] = hubRoleToString(_configManager.getHubRole());
+    String pushToken = _configManager.getPushToken();
+    deviceConfigObj["push_token_display"] = pushToken.length() > 0 ? "********" : ""; // Never echo any of the secret
+    deviceConfigObj["push_token_present"] = pushToken.length() > 0;
+
+
+    JsonObject eventsObj = doc.createNestedObject("event_queue");
+    EventQueue::Stats eventStats = _eventQueue.getStats();
+    eventsObj["capacity"] = eventStats.capacity;
+    eventsObj["in_use"] = eventStats.inUse;
+    eventsObj["high_water"] = eventStats.highWater;
+    eventsObj["published"] = eventStats.published;
+    eventsObj["dropped"] = eventStats.dropped;
+    eventsObj["coalesced"] = eventStats.coalesced;
+    JsonArray bucketLimits = eventsObj.createNestedArray("latency_bucket_limits_us");
+    for (uint32_t limit : EventQueue::LATENCY_BUCKET_LIMITS_US) {
+        bucketLimits.add(limit);
+    }
+    JsonObject lanesObj = eventsObj.createNestedObject("lanes");
+    for (uint8_t lane = 0; lane < EventQueue::LANE_COUNT; lane++) {
+        const EventQueue::LaneStats& laneStats = eventStats.lanes[lane];
+        JsonObject laneObj = lanesObj.createNestedObject(lane == EventQueue::LANE_CONTROL ? "control" : "data");
+        laneObj["queued"] = laneStats.queued;
+        laneObj["dispatched"] = laneStats.dispatched;
+        laneObj["max_latency_us"] = laneStats.maxLatencyUs;
+        JsonArray histogram = laneObj.createNestedArray("latency_histogram");
+        for (uint32_t count : laneStats.latencyHistogram) {
+            histogram.add(count);
+        }
+    }
 
+    JsonObject uiObj = doc.createNestedObject("ui_queue");
+    UIDispatchQueue::Stats uiStats = CardController::getUIQueueStats();
+    uiObj["capacity"] = uiStats.capacity;
+    uiObj["pending"] = uiStats.pending;
+    uiObj["high_water"] = uiStats.highWater;
+    uiObj["dispatched"] = uiStats.dispatched;
+    uiObj["dropped"] = uiStats.dropped;
+    uiObj["coalesced"] = uiStats.coalesced;
 
     JsonObject otaObj = doc.createNestedObject("ota");
     UpdateStatus status = _otaManager.getStatus();
@@ -649,6 +736,8 @@ void CaptivePortal::requestAction(PortalAction action, AsyncWebServerRequest *re
             if (request->hasParam("teamId", true)) new_action.param1 = request->getParam("teamId", true)->value();
             if (request->hasParam("apiKey", true)) new_action.param2 = request->getParam("apiKey", true)->value();
             if (request->hasParam("region", true)) new_action.param3 = request->getParam("region", true)->value();
+            if (request->hasParam("hubRole", true)) new_action.param4 = request->getParam("hubRole", true)->value();
+            if (request->hasParam("pushToken", true)) new_action.param5 = request->getParam("pushToken", true)->value();
         }
         // For actions like SCAN_WIFI, CHECK_OTA_UPDATE, START_OTA_UPDATE, params are not from request body initially.
 
@@ -695,11 +784,17 @@ void CaptivePortal::handleGetCardDefinitions(AsyncWebServerRequest *request) {
 }
 
 void CaptivePortal::handleGetConfiguredCards(AsyncWebServerRequest *request) {
-    DynamicJsonDocument doc(2048);
-    JsonArray cardsArray = doc.to<JsonArray>();
-
     // Get configured cards from ConfigManager
     std::vector<CardConfig> cardConfigs = _configManager.getCardConfigs();
+
+    // Size the document for the deck; strings are copied in
+    size_t capacity = JSON_ARRAY_SIZE(cardConfigs.size()) + cardConfigs.size() * JSON_OBJECT_SIZE(4);
+    for (const CardConfig& config : cardConfigs) {
+        capacity += config.config.length() + config.name.length() + 16;
+    }
+    DynamicJsonDocument doc(capacity + 256);
+    JsonArray cardsArray = doc.to<JsonArray>();
+
     for (const CardConfig& config : cardConfigs) {
         JsonObject cardObj = cardsArray.createNestedObject();
         cardObj["type"] = cardTypeToString(config.type);
@@ -715,19 +810,85 @@ void CaptivePortal::handleGetConfiguredCards(AsyncWebServerRequest *request) {
     request->send(response);
 }
 
+void CaptivePortal::handlePushInsight(AsyncWebServerRequest *request) {
+    int statusCode = 400;
+    String message = "Invalid push";
+
+    String insightId = request->hasParam("id") ? request->getParam("id")->value() : "";
+    String token = request->hasHeader("X-Push-Token") ? request->getHeader("X-Push-Token")->value() : "";
+    String expectedToken = _configManager.getPushToken();
+    String body;
+    if (request->_tempObject != NULL) {
+        body = String((char*)request->_tempObject);
+        free(request->_tempObject); // Clean up the allocated memory
+        request->_tempObject = NULL;
+    }
+
+    String snapshot;
+    if (expectedToken.isEmpty()) {
+        statusCode = 403;
+        message = "Pushes are disabled until a push token is set";
+    } else if (!tokensMatch(token, expectedToken)) {
+        statusCode = 401;
+        message = "Missing or wrong push token";
+    } else if (request->contentLength() > MAX_PUSH_BODY_SIZE) {
+        statusCode = 413;
+        message = "Insight data too large";
+    } else if (insightId.isEmpty() || insightId.length() > 64) {
+        message = "Missing or invalid insight id";
+    } else if (body.isEmpty()) {
+        message = "No insight data provided";
+    } else {
+        // Parse it as a card would; only the fields cards read are passed on
+        InsightParser parser(body.c_str());
+        if (!parser.isValid() ||
+            parser.getInsightType() == InsightParser::InsightType::INSIGHT_NOT_SUPPORTED ||
+            !parser.serializeSnapshot(snapshot)) {
+            message = "Body is not a PostHog insight a card can show";
+        } else {
+            _eventQueue.publishEvent(EventType::INSIGHT_DATA_PUSHED, insightId, snapshot);
+            statusCode = 202;
+            message = "Insight data accepted";
+            Serial.printf("Accepted pushed data for insight %s (%u bytes, %u after filtering)\n",
+                          insightId.c_str(), body.length(), snapshot.length());
+        }
+    }
+
+    DynamicJsonDocument responseDoc(256);
+    responseDoc["success"] = statusCode == 202;
+    responseDoc["message"] = message;
+
+    String responseJson;
+    serializeJson(responseDoc, responseJson);
+    request->send(statusCode, "application/json", responseJson);
+}
+
+bool CaptivePortal::tokensMatch(const String& given, const String& expected) {
+    // Compare every byte so the time taken doesn't reveal how much of the token was right
+    uint8_t difference = given.length() == expected.length() ? 0 : 1;
+    for (size_t i = 0; i < expected.length(); i++) {
+        uint8_t actual = i < given.length() ? (uint8_t)given[i] : 0;
+        difference |= actual ^ (uint8_t)expected[i];
+    }
+    return difference == 0;
+}
+
 void CaptivePortal::handleSaveConfiguredCards(AsyncWebServerRequest *request) {
     bool success = false;
     String message = "Failed to save card configuration";
 
     // Check if we have body data stored by the body handler
-    if (request->_tempObject != NULL) {
+    if (request->contentLength() > MAX_CARD_CONFIG_BODY_SIZE) {
+        message = "Card configuration too large";
+    } else if (request->_tempObject != NULL) {
         String body = String((char*)request->_tempObject);
         free(request->_tempObject); // Clean up the allocated memory
         request->_tempObject = NULL;
         
-        Serial.printf("Received card config body: %s\n", body.c_str());
+        Serial.printf("Received card config body (%u bytes)\n", body.length());
         
-        DynamicJsonDocument doc(2048);
+        // Each card's slots plus copied strings stay under three times its text
+        DynamicJsonDocument doc(body.length() * 3 + 256);
         DeserializationError error = deserializeJson(doc, body);
         
         if (!error && doc.is<JsonArray>()) {
@@ -44,6 +44,7 @@ const char* portalActionToString(PortalAction action);
  * - WiFi network selection and configuration
  * - Device configuration (team ID and API key)
  * - PostHog insight management
+ * - Push ingestion of insight data from a local relay
  * 
  * Implements standard captive portal detection for Android and Microsoft devices.
  * Caches WiFi scan results to improve responsiveness.
@@ -90,11 +91,19 @@ private:
         String param1;
         String param2;
         String param3;
+        String param4;
+        String param5;
     };
 
     // Max size for the action queue
     static const size_t MAX_ACTION_QUEUE_SIZE = 5;
 
+    // Largest pushed insight body accepted, matches InsightParser's document size
+    static const size_t MAX_PUSH_BODY_SIZE = 65536;
+
+    // Largest card deck body accepted, room for CardConfigStore::MAX_CARDS cards
+    static const size_t MAX_CARD_CONFIG_BODY_SIZE = 32768;
+
     // Member variables for asynchronous action handling
     std::vector<QueuedAction> _action_queue; // Action queue
     PortalAction _action_in_progress;
@@ -158,6 +167,21 @@ private:
      */
     void handleSaveConfiguredCards(AsyncWebServerRequest *request);
 
+    /**
+     * @brief Accept insight data pushed by a local relay
+     * Expects POST with ?id=<insight id>, the device's push token in an
+     * X-Push-Token header and a PostHog insight JSON body (full API response
+     * or compact snapshot). The body must parse as an insight a card can
+     * show; its compact snapshot is published as INSIGHT_DATA_PUSHED.
+     * Relays aren't browsers, so the route sends no CORS headers.
+     */
+    void handlePushInsight(AsyncWebServerRequest *request);
+
+    /**
+     * @brief Compare a received push token with the stored one in constant time
+     */
+    static bool tokensMatch(const String& given, const String& expected);
+
     /**
      * @brief Handle captive portal detection
      * Redirects to setup page for Android/Microsoft detection
@@ -201,6 +225,13 @@ private:
 
     // New handlers for async action requests and status
     void handleApiStatus(AsyncWebServerRequest *request);
+    
+    /**
+     * @brief Stream the trace ring as Chrome trace_event JSON
+     * 
+     * Save the response and open it in Perfetto (ui.perfetto.dev).
+     */
+    void handleApiTrace(AsyncWebServerRequest *request);
     void handleRequestWifiScan(AsyncWebServerRequest *request);
     void handleRequestSaveWifi(AsyncWebServerRequest *request);
     void handleRequestSaveDeviceConfig(AsyncWebServerRequest *request);
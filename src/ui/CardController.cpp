@@ -1,10 +1,14 @@
 #include "ui/CardController.h"
+#include "TraceBuffer.h"
 #include <algorithm>
+#include <new>
 
-QueueHandle_t CardController::uiQueue = nullptr;
+UIDispatchQueue* CardController::uiQueue = nullptr;
 
 // Define the global UI dispatch function
-std::function<void(std::function<void()>, bool)> globalUIDispatch;
+InlineFunction<void(UITask, bool), 16> globalUIDispatch;
+InlineFunction<void(const UIUpdateKey&, UITask), 16> globalUIDispatchKeyed;
+InlineFunction<void(const void*), 16> globalUICancel;
 
 CardController::CardController(
     lv_obj_t* screen,
@@ -30,6 +34,9 @@ CardController::CardController(
 }
 
 CardController::~CardController() {
+    // Stop event delivery before tearing anything down
+    subscriptions.clear();
+    
     // Clean up any allocated resources
     delete cardStack;
     cardStack = nullptr;
@@ -72,6 +79,29 @@ void CardController::initialize(DisplayInterface* display) {
     // Create card navigation stack
     cardStack = new CardNavigationStack(screen, screenWidth, screenHeight);
     
+    // Let the PostHog client prioritise requests for whichever insight is on
+    // screen, and only sample the performance HUD while it is showing
+    cardStack->setOnCardChanged([this](lv_obj_t* card) {
+        auto performance = dynamicCards.find(CardType::PERFORMANCE);
+        if (performance != dynamicCards.end()) {
+            for (const auto& instance : performance->second) {
+                static_cast<PerformanceCard*>(instance.handler)->setActive(instance.lvglCard == card);
+            }
+        }
+
+        String focusedInsight;
+        auto it = dynamicCards.find(CardType::INSIGHT);
+        if (it != dynamicCards.end()) {
+            for (const auto& instance : it->second) {
+                if (instance.lvglCard == card) {
+                    focusedInsight = static_cast<InsightCard*>(instance.handler)->getInsightId();
+                    break;
+                }
+            }
+        }
+        this->posthogClient.setFocusedInsight(focusedInsight);
+    });
+    
     // Create provision UI (always present, not configurable)
     provisioningCard = new ProvisioningCard(
         screen, 
@@ -99,23 +129,20 @@ void CardController::initialize(DisplayInterface* display) {
     
     
     // Subscribe to card configuration changes
-    eventQueue.subscribe([this](const Event& event) {
-        if (event.type == EventType::CARD_CONFIG_CHANGED) {
-            handleCardConfigChanged();
-        } else if (event.type == EventType::CARD_TITLE_UPDATED) {
-            handleCardTitleUpdated(event);
-        }
-    });
+    subscriptions.push_back(eventQueue.subscribe(EventType::CARD_CONFIG_CHANGED, [this](const Event& event) {
+        handleCardConfigChanged();
+    }));
+    subscriptions.push_back(eventQueue.subscribe(EventType::CARD_TITLE_UPDATED, [this](const Event& event) {
+        handleCardTitleUpdated(event);
+    }));
     
     // Subscribe to WiFi events
-    eventQueue.subscribe([this](const Event& event) {
-        if (event.type == EventType::WIFI_CONNECTING || 
-            event.type == EventType::WIFI_CONNECTED ||
-            event.type == EventType::WIFI_CONNECTION_FAILED ||
-            event.type == EventType::WIFI_AP_STARTED) {
+    for (EventType type : {EventType::WIFI_CONNECTING, EventType::WIFI_CONNECTED,
+                           EventType::WIFI_CONNECTION_FAILED, EventType::WIFI_AP_STARTED}) {
+        subscriptions.push_back(eventQueue.subscribe(type, [this](const Event& event) {
             handleWiFiEvent(event);
-        }
-    });
+        }));
+    }
 }
 
 void CardController::setDisplayInterface(DisplayInterface* display) {
@@ -229,7 +256,7 @@ void CardController::initializeCardTypes() {
         
         if (newCard && newCard->getCard()) {
             // Add to unified tracking system
-            CardInstance instance{newCard, newCard->getCard()};
+            CardInstance instance{newCard, newCard->getCard(), configValue};
             dynamicCards[CardType::INSIGHT].push_back(instance);
             
             // Register as input handler
@@ -261,7 +288,7 @@ void CardController::initializeCardTypes() {
         
         if (newCard && newCard->getCard()) {
             // Add to unified tracking system
-            CardInstance instance{newCard, newCard->getCard()};
+            CardInstance instance{newCard, newCard->getCard(), configValue};
             dynamicCards[CardType::FRIEND].push_back(instance);
             
             // Keep legacy pointer for backwards compatibility
@@ -290,7 +317,7 @@ void CardController::initializeCardTypes() {
         
         if (newCard && newCard->getCard()) {
             // Add to unified tracking system
-            CardInstance instance{newCard, newCard->getCard()};
+            CardInstance instance{newCard, newCard->getCard(), configValue};
             dynamicCards[CardType::HELLO_WORLD].push_back(instance);
             
             // Register as input handler
@@ -302,6 +329,32 @@ void CardController::initializeCardTypes() {
         return nullptr;
     };
     registerCardType(helloDef);
+    
+    // Register PERFORMANCE card type
+    CardDefinition performanceDef;
+    performanceDef.type = CardType::PERFORMANCE;
+    performanceDef.name = "Performance HUD";
+    performanceDef.allowMultiple = false;
+    performanceDef.needsConfigInput = false;
+    performanceDef.configInputLabel = "";
+    performanceDef.uiDescription = "Frame rate, CPU load, free memory and queue depths of this device";
+    performanceDef.factory = [this](const String& configValue) -> lv_obj_t* {
+        PerformanceCard* newCard = new PerformanceCard(screen, eventQueue);
+        
+        if (newCard && newCard->getCard()) {
+            // Add to unified tracking system
+            CardInstance instance{newCard, newCard->getCard(), configValue};
+            dynamicCards[CardType::PERFORMANCE].push_back(instance);
+            
+            // Register as input handler
+            cardStack->registerInputHandler(newCard->getCard(), newCard);
+            return newCard->getCard();
+        }
+        
+        delete newCard;
+        return nullptr;
+    };
+    registerCardType(performanceDef);
 }
 
 void CardController::handleCardConfigChanged() {
@@ -319,30 +372,43 @@ void CardController::reconcileCards(const std::vector<CardConfig>& newConfigs) {
         return;
     }
     
-    
-    // Track the number of cards before reconciliation
-    size_t oldCardCount = 0;
-    for (const auto& [cardType, cards] : dynamicCards) {
-        oldCardCount += cards.size();
-    }
-    
     reconcileInProgress = true;
     
     // Dispatch the entire reconciliation to the LVGL task to ensure thread safety
-    dispatchToLVGLTask([this, newConfigs, oldCardCount]() {
+    dispatchToLVGLTask([this, newConfigs]() {
         if (!displayInterface || !displayInterface->takeMutex(portMAX_DELAY)) {
             reconcileInProgress = false;  // Clear flag on failure
             return;
         }
         
-        // Save current card index to restore after reconciliation
-        uint8_t savedCardIndex = cardStack ? cardStack->getCurrentIndex() : 0;
+        std::vector<CardConfig> sortedConfigs = newConfigs;
+        std::sort(sortedConfigs.begin(), sortedConfigs.end(), 
+                  [](const CardConfig& a, const CardConfig& b) {
+                      return a.order < b.order;
+                  });
         
-        // Simple approach: Clear everything and rebuild from scratch
-        // This avoids complex diffing logic that can cause sync issues
+        // Claim an existing card for each config with the same (type, config);
+        // whatever is left unclaimed has been removed from the configuration
+        std::unordered_map<CardType, std::vector<CardInstance>> unclaimed;
+        unclaimed.swap(dynamicCards);
+        std::vector<lv_obj_t*> deck(sortedConfigs.size(), nullptr);
         
-        // Remove all existing dynamic cards using unified system
-        for (auto& [cardType, cards] : dynamicCards) {
+        for (size_t i = 0; i < sortedConfigs.size(); i++) {
+            const CardConfig& config = sortedConfigs[i];
+            std::vector<CardInstance>& candidates = unclaimed[config.type];
+            auto match = std::find_if(candidates.begin(), candidates.end(),
+                                      [&config](const CardInstance& instance) {
+                                          return instance.configValue == config.config;
+                                      });
+            if (match != candidates.end()) {
+                deck[i] = match->lvglCard;
+                dynamicCards[config.type].push_back(*match);
+                candidates.erase(match);
+            }
+        }
+        
+        size_t cardsRemoved = 0;
+        for (auto& [cardType, cards] : unclaimed) {
             for (auto& cardInstance : cards) {
                 if (cardInstance.lvglCard) {
                     // Notify the card that its LVGL object will be managed externally
@@ -350,32 +416,24 @@ void CardController::reconcileCards(const std::vector<CardConfig>& newConfigs) {
                     // Remove from navigation stack (this deletes the LVGL object)
                     cardStack->removeCard(cardInstance.lvglCard);
                 }
+                if (cardInstance.handler == animationCard) {
+                    animationCard = nullptr;
+                }
                 delete cardInstance.handler;
+                cardsRemoved++;
             }
         }
-        dynamicCards.clear();
-        
-        // Clear legacy pointer
-        animationCard = nullptr;
-        
-        // Force LVGL to process all pending operations
-        lv_refr_now(NULL);
-        
-        // Now recreate cards based on new configuration
-        std::vector<CardConfig> sortedConfigs = newConfigs;
-        std::sort(sortedConfigs.begin(), sortedConfigs.end(), 
-                  [](const CardConfig& a, const CardConfig& b) {
-                      return a.order < b.order;
-                  });
         
-        // Track how many cards we've created
+        // Create only the cards that are new to the configuration
+        std::vector<bool> created(sortedConfigs.size(), false);
         size_t cardsCreated = 0;
-        
-        // Check if we have a new card (more configs than before)
-        bool hasNewCard = (sortedConfigs.size() > oldCardCount);
-        size_t newCardPosition = 0;
+        uint8_t newCardPosition = 0;
         
         for (size_t i = 0; i < sortedConfigs.size(); i++) {
+            if (deck[i]) {
+                continue;
+            }
+            
             const CardConfig& config = sortedConfigs[i];
             // Find the registered card type
             auto it = std::find_if(registeredCardTypes.begin(), registeredCardTypes.end(),
@@ -388,12 +446,8 @@ void CardController::reconcileCards(const std::vector<CardConfig>& newConfigs) {
                 lv_obj_t* cardObj = it->factory(config.config);
                 if (cardObj) {
                     cardStack->addCard(cardObj);
-                    
-                    // Track position of new card if this is likely the new one
-                    if (hasNewCard && i == sortedConfigs.size() - 1) {
-                        newCardPosition = cardsCreated + 1; // +1 for provisioning card
-                    }
-                    
+                    deck[i] = cardObj;
+                    created[i] = true;
                     cardsCreated++;
                 } else {
                     Serial.printf("Failed to create card of type %s\n", 
@@ -405,23 +459,40 @@ void CardController::reconcileCards(const std::vector<CardConfig>& newConfigs) {
             }
         }
         
-        // Force another LVGL refresh to ensure everything is properly laid out
-        lv_refr_now(NULL);
+        // Put the cards in configured order, after the provisioning card
+        uint8_t position = 1;
+        for (size_t i = 0; i < deck.size(); i++) {
+            if (!deck[i]) {
+                continue;
+            }
+            if (lv_obj_get_index(deck[i]) != position) {
+                cardStack->moveCard(deck[i], position);
+            }
+            // Show the last card created, which is likely the one just added
+            if (created[i]) {
+                newCardPosition = position;
+            }
+            position++;
+        }
+        
+        Serial.printf("[CardController] Reconciled cards: %u kept, %u created, %u removed\n",
+                      (unsigned)(position - 1 - cardsCreated), (unsigned)cardsCreated, (unsigned)cardsRemoved);
+        
+        // Lay out the changed stack so navigation sees final card positions;
+        // drawing happens on the next regular refresh
+        lv_obj_update_layout(screen);
         
         // Force the card stack to update its pip indicators
         // This ensures the indicators are correct after bulk card operations
         cardStack->forceUpdateIndicators();
         
         // Navigate to appropriate card
-        if (hasNewCard && newCardPosition > 0) {
+        if (newCardPosition > 0) {
             // Navigate to the newly added card
             cardStack->goToCard(newCardPosition);
-        } else if (savedCardIndex > 0 && cardsCreated > 0) {
-            // Restore previous position if no new card was added
-            // Adjust for the provisioning card (always at index 0)
-            uint8_t maxIndex = cardsCreated; // provisioning + created cards - 1
-            uint8_t targetIndex = (savedCardIndex <= maxIndex) ? savedCardIndex : maxIndex;
-            cardStack->goToCard(targetIndex);
+        } else {
+            // Keep the visible card in view at its possibly new position
+            cardStack->goToCard(cardStack->getCurrentIndex());
         }
         
         // Clear the in-progress flag
@@ -433,14 +504,20 @@ void CardController::reconcileCards(const std::vector<CardConfig>& newConfigs) {
 
 void CardController::initUIQueue() {
     if (uiQueue == nullptr) {
-        uiQueue = xQueueCreate(20, sizeof(UICallback*));
+        uiQueue = new (std::nothrow) UIDispatchQueue();
         if (uiQueue == nullptr) {
             Serial.println("[UI-CRITICAL] Failed to create UI task queue!");
         } else {
             // Set the global dispatch function to point to our method
-            globalUIDispatch = [this](std::function<void()> func, bool to_front) {
+            globalUIDispatch = [this](UITask func, bool to_front) {
                 this->dispatchToLVGLTask(std::move(func), to_front);
             };
+            globalUIDispatchKeyed = [this](const UIUpdateKey& key, UITask func) {
+                this->dispatchKeyedToLVGLTask(key, std::move(func));
+            };
+            globalUICancel = [](const void* owner) {
+                uiQueue->cancel(owner);
+            };
         }
     }
 }
@@ -448,39 +525,54 @@ void CardController::initUIQueue() {
 void CardController::processUIQueue() {
     if (uiQueue == nullptr) return;
 
-    UICallback* callback_ptr = nullptr;
-    while (xQueueReceive(uiQueue, &callback_ptr, 0) == pdTRUE) {
-        if (callback_ptr) {
-            callback_ptr->execute();
-            delete callback_ptr;
-        }
+    if (uiQueue->empty()) return;
+
+    TraceBuffer::Span span("ui.drain");
+    uiQueue->drain();
+}
+
+void CardController::dispatchToLVGLTask(UITask update_func, bool to_front) {
+    if (uiQueue == nullptr) {
+        Serial.println("[UI-ERROR] UI Queue not initialized, cannot dispatch UI update.");
+        return;
+    }
+
+    if (!update_func) {
+        return;
+    }
+
+    TraceBuffer::instant("ui.dispatch", to_front);
+    if (!uiQueue->push(std::move(update_func), to_front)) {
+        Serial.printf("[UI-WARN] UI queue full (send_to_front: %d), update discarded. Core: %d\n", 
+                      to_front, xPortGetCoreID());
+    } else if (displayInterface) {
+        displayInterface->wake();
     }
 }
 
-void CardController::dispatchToLVGLTask(std::function<void()> update_func, bool to_front) {
+void CardController::dispatchKeyedToLVGLTask(const UIUpdateKey& key, UITask update_func) {
     if (uiQueue == nullptr) {
         Serial.println("[UI-ERROR] UI Queue not initialized, cannot dispatch UI update.");
         return;
     }
 
-    UICallback* callback = new UICallback(std::move(update_func));
-    if (!callback) {
-        Serial.println("[UI-CRITICAL] Failed to allocate UICallback for dispatch!");
+    if (!update_func) {
         return;
     }
 
-    BaseType_t queue_send_result;
-    if (to_front) {
-        queue_send_result = xQueueSendToFront(uiQueue, &callback, (TickType_t)0); 
-    } else {
-        queue_send_result = xQueueSend(uiQueue, &callback, (TickType_t)0);
+    TraceBuffer::instant("ui.dispatch", key.kind);
+    if (!uiQueue->pushKeyed(key, std::move(update_func))) {
+        Serial.printf("[UI-WARN] UI queue full (keyed), update discarded. Core: %d\n", xPortGetCoreID());
+    } else if (displayInterface) {
+        displayInterface->wake();
     }
+}
 
-    if (queue_send_result != pdTRUE) {
-        Serial.printf("[UI-WARN] UI queue full/error (send_to_front: %d), update discarded. Core: %d\n", 
-                      to_front, xPortGetCoreID());
-        delete callback;
+UIDispatchQueue::Stats CardController::getUIQueueStats() {
+    if (uiQueue == nullptr) {
+        return UIDispatchQueue::Stats{};
     }
+    return uiQueue->getStats();
 }
 
 void CardController::handleCardTitleUpdated(const Event& event) {
@@ -13,10 +13,12 @@
 #include "ui/InsightCard.h"
 #include "ui/FriendCard.h"
 #include "ui/examples/HelloWorldCard.h"
+#include "ui/PerformanceCard.h"
 #include "hardware/DisplayInterface.h"
 #include "EventQueue.h"
 #include "config/CardConfig.h"
 #include "UICallback.h"
+#include "UIDispatchQueue.h"
 
 /**
  * @class CardController
@@ -128,7 +130,7 @@ public:
     /**
      * @brief Initialize the UI update queue
      * 
-     * Creates a FreeRTOS queue for handling UI updates across threads.
+     * Creates the per-core rings for handing UI updates across threads.
      * Must be called once during CardController initialization.
      */
     void initUIQueue();
@@ -145,12 +147,27 @@ public:
      * @brief Thread-safe method to dispatch UI updates to the LVGL task
      * 
      * @param update_func Lambda function containing UI operations
-     * @param to_front If true, tries to add the callback to the front of the queue
+     * @param to_front If true, runs the callback ahead of normal updates
      * 
-     * Queues UI operations to be executed on the LVGL thread.
-     * Handles queue overflow by discarding updates if queue is full.
+     * Queues UI operations to be executed on the LVGL thread without
+     * allocating. Updates are discarded, and counted, if the ring for the
+     * calling core is full.
      */
-    void dispatchToLVGLTask(std::function<void()> update_func, bool to_front = false);
+    void dispatchToLVGLTask(UITask update_func, bool to_front = false);
+
+    /**
+     * @brief Dispatch a UI update that replaces any pending one with the same key
+     * 
+     * @param key Owner and kind of the update
+     * @param update_func Lambda function containing UI operations
+     */
+    void dispatchKeyedToLVGLTask(const UIUpdateKey& key, UITask update_func);
+    
+    /**
+     * @brief Get UI queue usage
+     * @return Counters for the UI dispatch rings, zeroed before initialization
+     */
+    static UIDispatchQueue::Stats getUIQueueStats();
 
 private:
     // Screen reference
@@ -163,6 +180,7 @@ private:
     WiFiInterface& wifiInterface;  ///< WiFi interface reference
     PostHogClient& posthogClient;  ///< PostHog client reference
     EventQueue& eventQueue;        ///< Event queue reference
+    std::vector<EventSubscription> subscriptions; ///< Event handlers bound to this controller
     
     // UI Components
     CardNavigationStack* cardStack;     ///< Navigation stack for cards
@@ -172,6 +190,7 @@ private:
     struct CardInstance {
         InputHandler* handler;  ///< The card as an InputHandler
         lv_obj_t* lvglCard;    ///< The LVGL card object
+        String configValue;    ///< Config it was created from; with the type, its reconcile key
     };
     std::unordered_map<CardType, std::vector<CardInstance>> dynamicCards; ///< All dynamic cards by type
     
@@ -182,7 +201,7 @@ private:
     DisplayInterface* displayInterface;  ///< Thread-safe display interface
     
     // UI Threading
-    static QueueHandle_t uiQueue;  ///< Queue for thread-safe UI updates
+    static UIDispatchQueue* uiQueue;  ///< Rings for thread-safe UI updates
     
     // Card registration and management
     std::vector<CardDefinition> registeredCardTypes; ///< Available card types with factory functions
@@ -222,6 +241,10 @@ private:
      * @brief Reconcile current cards with new configuration
      * Diffs configuration, removes old cards, creates new ones, and reorders
      * @param newConfigs New card configuration from storage
+     * 
+     * Cards are keyed on (type, config value). Cards whose key is still
+     * configured are kept as they are, with their data and subscriptions,
+     * so only added cards are created and fetch data.
      */
     void reconcileCards(const std::vector<CardConfig>& newConfigs);
 }; 
\ No newline at end of file
@@ -159,6 +159,10 @@ void CardNavigationStack::goToCard(uint8_t index) {
     vTaskDelay(pdMS_TO_TICKS(1));
     
     _update_scroll_indicator(_current_card);
+    
+    if (_on_card_changed) {
+        _on_card_changed(target_card);
+    }
 }
 
 uint8_t CardNavigationStack::getCurrentIndex() const {
@@ -236,6 +240,10 @@ void CardNavigationStack::registerInputHandler(lv_obj_t* card, InputHandler* han
     _input_handlers.push_back(std::make_pair(card, handler));
 }
 
+void CardNavigationStack::setOnCardChanged(std::function<void(lv_obj_t*)> callback) {
+    _on_card_changed = std::move(callback);
+}
+
 void CardNavigationStack::forceUpdateIndicators() {
     // Force update pip count
     _update_pip_count();
@@ -371,8 +379,8 @@ bool CardNavigationStack::removeCard(lv_obj_t* card) {
     // Delete the card from LVGL
     lv_obj_del(card);
     
-    // Force LVGL to process the deletion
-    lv_refr_now(NULL);
+    // Re-lay out the remaining cards so scrolling lands on the right one
+    lv_obj_update_layout(_main_container);
     
     // Update the scroll indicator (this will recreate all pips)
     _update_pip_count();
@@ -387,6 +395,10 @@ bool CardNavigationStack::removeCard(lv_obj_t* card) {
         lv_obj_t* selected_card = lv_obj_get_child(_main_container, _current_card);
         if (selected_card) {
             lv_obj_scroll_to_view(selected_card, LV_ANIM_ON);
+            
+            if (_on_card_changed) {
+                _on_card_changed(selected_card);
+            }
         }
         
         // Update scroll indicator after scrolling
@@ -397,4 +409,19 @@ bool CardNavigationStack::removeCard(lv_obj_t* card) {
     }
     
     return true;
-}
\ No newline at end of file
+}
+
+bool CardNavigationStack::moveCard(lv_obj_t* card, uint8_t index) {
+    if (lv_obj_get_parent(card) != _main_container) {
+        return false; // Card not in our container
+    }
+    
+    // Keep the selection on the card that is showing, wherever it ends up
+    lv_obj_t* current = lv_obj_get_child(_main_container, _current_card);
+    lv_obj_move_to_index(card, index);
+    if (current) {
+        _current_card = lv_obj_get_index(current);
+    }
+    
+    return true;
+}
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <Bounce2.h>
 #include <vector>
+#include <functional>
 #include "ui/InputHandler.h"
 
 // Forward declaration
@@ -49,6 +50,17 @@ public:
      */
     bool removeCard(lv_obj_t* card);
     
+    /**
+     * @brief Move a card to a new position in the stack
+     * @param card LVGL object to move
+     * @param index Zero-based target index
+     * @return true if the card was found in the stack
+     * 
+     * The current index follows the card that was visible, so the
+     * selection doesn't jump to a different card. Doesn't scroll.
+     */
+    bool moveCard(lv_obj_t* card, uint8_t index);
+    
     /**
      * @brief Navigate to next card with animation
      * 
@@ -113,6 +125,14 @@ public:
      */
     void forceUpdateIndicators();
     
+    /**
+     * @brief Register a callback for active card changes
+     * @param callback Called with the newly active card's LVGL object
+     * 
+     * Invoked from the LVGL task whenever navigation selects a different card.
+     */
+    void setOnCardChanged(std::function<void(lv_obj_t*)> callback);
+    
 private:
     /**
      * @brief LVGL scroll event callback
@@ -153,4 +173,7 @@ private:
     
     // Input handling
     std::vector<std::pair<lv_obj_t*, InputHandler*>> _input_handlers;  ///< Card-specific input handlers
+    
+    // Navigation notifications
+    std::function<void(lv_obj_t*)> _on_card_changed;  ///< Optional active card change callback
 }; 
\ No newline at end of file
@@ -7,6 +7,27 @@
 #include "renderers/FunnelRenderer.h"
 #include "hardware/Input.h"
 #include "../AsyncNetworkManager.h"
+#include "../TraceBuffer.h"
+
+namespace {
+
+// Pool slots; every unsupported type falls back to the numeric renderer
+constexpr size_t NUMERIC_SLOT = 0;
+constexpr size_t LINE_GRAPH_SLOT = 1;
+constexpr size_t FUNNEL_SLOT = 2;
+
+size_t rendererSlot(InsightParser::InsightType type) {
+    switch (type) {
+        case InsightParser::InsightType::LINE_GRAPH:
+            return LINE_GRAPH_SLOT;
+        case InsightParser::InsightType::FUNNEL:
+            return FUNNEL_SLOT;
+        default:
+            return NUMERIC_SLOT;
+    }
+}
+
+}
 
 
 InsightCard::InsightCard(lv_obj_t* parent, ConfigManager& config, EventQueue& eventQueue,
@@ -75,25 +96,31 @@ InsightCard::InsightCard(lv_obj_t* parent, ConfigManager& config, EventQueue& ev
     lv_obj_set_style_border_width(_content_container, 0, 0);
     lv_obj_set_style_pad_all(_content_container, 0, 0);
 
-    _event_queue.subscribe([this](const Event& event) {
-        if (event.insightId == _insight_id) {
-            if (event.type == EventType::INSIGHT_DATA_RECEIVED) {
-                this->onEvent(event);
-            } else if (event.type == EventType::INSIGHT_DATA_ERROR) {
-                this->onErrorEvent(event);
-            } else if (event.type == EventType::INSIGHT_NETWORK_STATE_CHANGED) {
-                this->onNetworkStateChanged(event);
-            }
-        }
-    });
+    _subscriptions.push_back(_event_queue.subscribe(EventType::INSIGHT_DATA_RECEIVED, _insight_id, [this](const Event& event) {
+        this->onEvent(event);
+    }));
+    _subscriptions.push_back(_event_queue.subscribe(EventType::INSIGHT_DATA_ERROR, _insight_id, [this](const Event& event) {
+        this->onErrorEvent(event);
+    }));
+    _subscriptions.push_back(_event_queue.subscribe(EventType::INSIGHT_NETWORK_STATE_CHANGED, _insight_id, [this](const Event& event) {
+        this->onNetworkStateChanged(event);
+    }));
 }
 
 InsightCard::~InsightCard() {
     Serial.printf("[InsightCard-%s] DESTRUCTOR called\n", _insight_id.c_str());
-    std::shared_ptr<InsightRendererBase> renderer_for_lambda = std::move(_active_renderer);
+    // Stop event delivery before any member goes away
+    _subscriptions.clear();
+    _active_renderer = nullptr;
+    auto renderers = std::make_shared<std::vector<std::unique_ptr<InsightRendererBase>>>();
+    for (PooledRenderer& pooled : _renderers) {
+        if (pooled.renderer) {
+            renderers->push_back(std::move(pooled.renderer));
+        }
+    }
     if (globalUIDispatch) {
-        globalUIDispatch([card_obj = _card, renderer = renderer_for_lambda]() mutable {
-            if (renderer) {
+        globalUIDispatch([card_obj = _card, renderers]() mutable {
+            for (auto& renderer : *renderers) {
                 renderer->clearElements();
             }
             if (card_obj && lv_obj_is_valid(card_obj)) {
@@ -106,6 +133,7 @@ InsightCard::~InsightCard() {
 void InsightCard::onEvent(const Event& event) {
     std::shared_ptr<InsightParser> parser = nullptr;
     if (event.jsonData.length() > 0) {
+        TraceBuffer::Span span("insight.parse", event.jsonData.length());
         parser = std::make_shared<InsightParser>(event.jsonData.c_str());
     } else if (event.parser) {
         parser = event.parser;
@@ -123,10 +151,8 @@ void InsightCard::handleParsedData(std::shared_ptr<InsightParser> parser) {
         if (globalUIDispatch) {
             globalUIDispatch([this]() {
                 if(isValidObject(_title_label)) lv_label_set_text(_title_label, "Data Error");
-                if (_active_renderer) {
-                    _active_renderer->clearElements();
-                    _active_renderer.reset();
-                }
+                hideRenderers();
+                _active_renderer = nullptr;
                 _current_type = InsightParser::InsightType::INSIGHT_NOT_SUPPORTED;
             }, true);
         }
@@ -162,43 +188,17 @@ void InsightCard::handleParsedData(std::shared_ptr<InsightParser> parser) {
         }
 
         if (needs_rebuild) {
-            Serial.printf("[InsightCard-%s] Rebuilding renderer START. Old type: %d, New type: %d. Core: %d, Card: %p, Container: %p\n", 
+            Serial.printf("[InsightCard-%s] Switching renderer. Old type: %d, New type: %d. Core: %d, Card: %p, Container: %p\n", 
                 id.c_str(), (int)_current_type, (int)new_insight_type, xPortGetCoreID(), _card, _content_container);
 
-            if (_active_renderer) {
-                _active_renderer->clearElements();
-                _active_renderer.reset();
+            if (rendererSlot(new_insight_type) == NUMERIC_SLOT &&
+                new_insight_type != InsightParser::InsightType::NUMERIC_CARD) {
+                Serial.printf("[InsightCard-%s] Unsupported insight type %d. Using Numeric as fallback.\n", 
+                    id.c_str(), (int)new_insight_type);
             }
-            clearContentContainer();
             _current_type = new_insight_type;
-
-            switch (new_insight_type) {
-                case InsightParser::InsightType::NUMERIC_CARD:
-                    _active_renderer = std::make_unique<NumericCardRenderer>();
-                    break;
-                case InsightParser::InsightType::LINE_GRAPH:
-                    _active_renderer = std::make_unique<LineGraphRenderer>();
-                    break;
-                case InsightParser::InsightType::FUNNEL:
-                    _active_renderer = std::make_unique<FunnelRenderer>();
-                    break;
-                default:
-                    Serial.printf("[InsightCard-%s] Unsupported insight type %d. Using Numeric as fallback.\n", 
-                        id.c_str(), (int)new_insight_type);
-                    _active_renderer = std::make_unique<NumericCardRenderer>(); 
-                    break;
-            }
-
-            if (_active_renderer) {
-                _active_renderer->createElements(_content_container);
-                if (isValidObject(_content_container)) {
-                    lv_obj_invalidate(_content_container);
-                }
-                lv_display_t* disp = lv_display_get_default();
-                if (disp) {
-                    lv_refr_now(disp);
-                }
-            } else {
+            _active_renderer = activateRenderer(new_insight_type);
+            if (!_active_renderer) {
                 Serial.printf("[InsightCard-%s] CRITICAL: Failed to create a renderer!\n", id.c_str());
             }
         }
@@ -221,9 +221,74 @@ void InsightCard::handleParsedData(std::shared_ptr<InsightParser> parser) {
     }
 }
 
-void InsightCard::clearContentContainer() {
-    if (isValidObject(_content_container)) {
-        lv_obj_clean(_content_container);
+InsightRendererBase* InsightCard::activateRenderer(InsightParser::InsightType type) {
+    if (!isValidObject(_content_container)) {
+        return nullptr;
+    }
+
+    size_t slot = rendererSlot(type);
+    PooledRenderer& pooled = _renderers[slot];
+
+    // Show only this renderer's holder; the others keep their elements
+    for (size_t i = 0; i < RENDERER_KINDS; i++) {
+        if (i != slot && isValidObject(_renderers[i].holder)) {
+            lv_obj_add_flag(_renderers[i].holder, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+
+    bool needs_elements = false;
+    if (!pooled.renderer || !isValidObject(pooled.holder)) {
+        if (pooled.renderer) {
+            pooled.renderer->clearElements();
+        }
+        pooled.holder = lv_obj_create(_content_container);
+        if (!pooled.holder) {
+            pooled.renderer.reset();
+            return nullptr;
+        }
+        lv_obj_set_size(pooled.holder, lv_pct(100), lv_pct(100));
+        lv_obj_set_style_bg_opa(pooled.holder, LV_OPA_0, 0);
+        lv_obj_set_style_border_width(pooled.holder, 0, 0);
+        lv_obj_set_style_pad_all(pooled.holder, 0, 0);
+        lv_obj_clear_flag(pooled.holder, LV_OBJ_FLAG_SCROLLABLE);
+
+        switch (slot) {
+            case LINE_GRAPH_SLOT:
+                pooled.renderer = std::make_unique<LineGraphRenderer>();
+                break;
+            case FUNNEL_SLOT:
+                pooled.renderer = std::make_unique<FunnelRenderer>();
+                break;
+            default:
+                pooled.renderer = std::make_unique<NumericCardRenderer>();
+                break;
+        }
+        needs_elements = true;
+    } else if (!pooled.renderer->areElementsValid()) {
+        Serial.printf("[InsightCard-%s] Pooled renderer elements are invalid. Rebuilding.\n", _insight_id.c_str());
+        pooled.renderer->clearElements();
+        lv_obj_clean(pooled.holder);
+        needs_elements = true;
+    }
+
+    lv_obj_clear_flag(pooled.holder, LV_OBJ_FLAG_HIDDEN);
+
+    if (needs_elements) {
+        // Lay out only as far as the renderer needs: the holder's size
+        // before it builds, its new elements' sizes after
+        lv_obj_update_layout(pooled.holder);
+        pooled.renderer->createElements(pooled.holder);
+        lv_obj_update_layout(pooled.holder);
+        pooled.renderer->onLayoutReady();
+    }
+    return pooled.renderer.get();
+}
+
+void InsightCard::hideRenderers() {
+    for (PooledRenderer& pooled : _renderers) {
+        if (isValidObject(pooled.holder)) {
+            lv_obj_add_flag(pooled.holder, LV_OBJ_FLAG_HIDDEN);
+        }
     }
 }
 
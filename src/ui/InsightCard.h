@@ -25,6 +25,7 @@ class InsightRendererBase;
  * Features:
  * - Thread-safe UI updates via queue system
  * - Automatic insight type detection and UI adaptation
+ * - Renderers pooled per type, so type changes reuse their LVGL objects
  * - Memory-safe LVGL object management
  * - Smart number formatting with unit scaling (K, M)
  */
@@ -127,17 +128,26 @@ private:
      * @param parser Shared pointer to parsed insight data
      * 
      * Updates the card's visualization based on the insight type.
-     * Handles type changes by recreating UI elements as needed.
+     * Handles type changes by switching to the pooled renderer for the new type.
      */
     void handleParsedData(std::shared_ptr<InsightParser> parser);
     
     /**
-     * @brief Clear the content container
+     * @brief Show the pooled renderer for a type, building it on first use
      * 
-     * Safely removes all UI elements from the content container
-     * and resets internal element pointers to nullptr.
+     * @param type Insight type to display (unsupported types use numeric)
+     * @return The renderer now shown, or nullptr if it couldn't be created
+     * 
+     * Other pooled renderers are hidden, not deleted, so switching back is a
+     * visibility toggle. Elements are only rebuilt if they became invalid.
+     * Must run on the LVGL thread.
+     */
+    InsightRendererBase* activateRenderer(InsightParser::InsightType type);
+    
+    /**
+     * @brief Hide every pooled renderer, keeping their elements for reuse
      */
-    void clearContentContainer();
+    void hideRenderers();
     
     /**
      * @brief Check if an LVGL object is valid
@@ -153,6 +163,7 @@ private:
     // Configuration and state
     ConfigManager& _config;              ///< Configuration manager reference
     EventQueue& _event_queue;            ///< Event queue reference
+    std::vector<EventSubscription> _subscriptions; ///< Released first on destruction
     String _insight_id;                  ///< Unique insight identifier
     String _current_title;               ///< Current card title
     InsightParser::InsightType _current_type; ///< Current visualization type
@@ -170,7 +181,17 @@ private:
     bool _is_showing_cached_data;       ///< Whether currently showing cached data
     
     // Renderer related members
-    std::unique_ptr<InsightRendererBase> _active_renderer; ///< Smart pointer to the current renderer
+    static constexpr size_t RENDERER_KINDS = 3;   ///< Numeric, line graph, funnel
+    
+    /**
+     * @brief A renderer kept across type changes, with the holder its elements live in
+     */
+    struct PooledRenderer {
+        std::unique_ptr<InsightRendererBase> renderer;
+        lv_obj_t* holder = nullptr;     ///< Full-size child of the content container, hidden when inactive
+    };
+    PooledRenderer _renderers[RENDERER_KINDS];     ///< Indexed by rendererSlot()
+    InsightRendererBase* _active_renderer;         ///< Shown renderer, owned by _renderers
     
     /**
      * @brief Show loading state with spinner
@@ -0,0 +1,307 @@
+#include "ui/PerformanceCard.h"
+#include "ui/CardController.h"
+#include "Style.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#if !(configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY)
+#include <esp_freertos_hooks.h>
+
+namespace {
+
+// Idle loop iterations per core, counted only while the card is on screen.
+// Each counter is written by one core's idle task and read by the LVGL task.
+volatile uint32_t idleCalls[2] = {0, 0};
+
+// Returning false keeps the idle task looping instead of waiting for an
+// interrupt, so the call count tracks how long the core sat idle
+bool idleHookCore0() {
+    idleCalls[0]++;
+    return false;
+}
+
+bool idleHookCore1() {
+    idleCalls[1]++;
+    return false;
+}
+
+void setIdleHooks(bool enable) {
+    if (enable) {
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+    } else {
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+    }
+}
+
+} // namespace
+#endif
+
+PerformanceCard::PerformanceCard(lv_obj_t* parent, EventQueue& eventQueue)
+    : _eventQueue(eventQueue)
+    , _card(nullptr)
+    , _frameLabel(nullptr)
+    , _cpuLabel(nullptr)
+    , _heapLabel(nullptr)
+    , _queueLabel(nullptr)
+    , _frameChart(nullptr)
+    , _cpuChart(nullptr)
+    , _frameSeries(nullptr)
+    , _cpuSeries{nullptr, nullptr}
+    , _timer(nullptr)
+    , _display(nullptr)
+    , _active(false)
+    , _renderStartUs(0)
+    , _frames(0)
+    , _renderTotalUs(0)
+    , _lastSampleMs(0)
+    , _lastIdleRunTime{0, 0}
+    , _lastTotalRunTime(0)
+    , _peakIdleRate{0, 0} {
+
+    _card = lv_obj_create(parent);
+    if (!_card) return;
+
+    lv_obj_set_width(_card, lv_pct(100));
+    lv_obj_set_height(_card, lv_pct(100));
+    lv_obj_set_style_bg_color(_card, Style::backgroundColor(), 0);
+    lv_obj_set_style_border_width(_card, 0, 0);
+    lv_obj_set_style_pad_all(_card, 8, 0);
+    lv_obj_set_style_margin_all(_card, 0, 0);
+    lv_obj_clear_flag(_card, LV_OBJ_FLAG_SCROLLABLE);
+
+    _frameLabel = createLabel(0);
+    _cpuLabel = createLabel(30);
+    _heapLabel = createLabel(60);
+    _queueLabel = createLabel(90);
+
+    // Render time in ms, CPU load in percent
+    _frameChart = createSparkline(0, 50);
+    _cpuChart = createSparkline(30, 100);
+    if (_frameChart) {
+        _frameSeries = lv_chart_add_series(_frameChart, Style::accentColor(), LV_CHART_AXIS_PRIMARY_Y);
+    }
+    if (_cpuChart) {
+        _cpuSeries[0] = lv_chart_add_series(_cpuChart, lv_color_hex(0xF1A82C), LV_CHART_AXIS_PRIMARY_Y);
+        _cpuSeries[1] = lv_chart_add_series(_cpuChart, lv_color_hex(0x1D4AFF), LV_CHART_AXIS_PRIMARY_Y);
+    }
+
+    _display = lv_obj_get_display(_card);
+    if (_display) {
+        lv_display_add_event_cb(_display, renderEventCallback, LV_EVENT_RENDER_START, this);
+        lv_display_add_event_cb(_display, renderEventCallback, LV_EVENT_RENDER_READY, this);
+    }
+
+    // Sampling starts once the card is shown
+    _timer = lv_timer_create(sampleTimerCallback, SAMPLE_PERIOD_MS, this);
+    if (_timer) {
+        lv_timer_pause(_timer);
+    }
+}
+
+PerformanceCard::~PerformanceCard() {
+    setActive(false);
+    if (_timer) {
+        lv_timer_delete(_timer);
+        _timer = nullptr;
+    }
+
+    if (_display) {
+        lv_display_remove_event_cb_with_user_data(_display, renderEventCallback, this);
+        _display = nullptr;
+    }
+
+    // Card deletion is managed by CardNavigationStack unless it never took over
+    if (_card) {
+        lv_obj_del_async(_card);
+        _card = nullptr;
+    }
+}
+
+void PerformanceCard::setActive(bool active) {
+    if (active == _active || !_timer) {
+        return;
+    }
+    _active = active;
+
+    if (active) {
+#if !(configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY)
+        setIdleHooks(true);
+#endif
+        // Start from a fresh baseline so the first sample doesn't span the time hidden
+        _frames = 0;
+        _renderTotalUs = 0;
+        _lastSampleMs = lv_tick_get();
+        sampleCpuLoad(nullptr);
+        lv_timer_reset(_timer);
+        lv_timer_resume(_timer);
+    } else {
+        lv_timer_pause(_timer);
+#if !(configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY)
+        setIdleHooks(false);
+#endif
+    }
+}
+
+bool PerformanceCard::handleButtonPress(uint8_t button_index) {
+    (void)button_index;
+    return false;
+}
+
+lv_obj_t* PerformanceCard::createLabel(int16_t y) {
+    lv_obj_t* label = lv_label_create(_card);
+    if (!label) return nullptr;
+
+    lv_obj_set_style_text_font(label, Style::labelFont(), 0);
+    lv_obj_set_style_text_color(label, Style::valueColor(), 0);
+    lv_label_set_text(label, "");
+    lv_obj_align(label, LV_ALIGN_TOP_LEFT, 0, y);
+    return label;
+}
+
+lv_obj_t* PerformanceCard::createSparkline(int16_t y, int32_t max) {
+    lv_obj_t* chart = lv_chart_create(_card);
+    if (!chart) return nullptr;
+
+    lv_obj_set_size(chart, 84, 24);
+    lv_obj_align(chart, LV_ALIGN_TOP_RIGHT, 0, y);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+    lv_chart_set_point_count(chart, HISTORY_POINTS);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, max);
+    lv_chart_set_div_line_count(chart, 0, 0);
+    lv_obj_clear_flag(chart, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_set_style_bg_color(chart, lv_color_hex(0x050505), 0);
+    lv_obj_set_style_border_width(chart, 0, 0);
+    lv_obj_set_style_radius(chart, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(chart, 0, LV_PART_MAIN);
+    lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR); // No dots on points
+    lv_obj_set_style_line_width(chart, 1, LV_PART_ITEMS);
+    return chart;
+}
+
+void PerformanceCard::setLabelText(lv_obj_t* label, const char* text) {
+    if (label && strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+void PerformanceCard::sample() {
+    char text[48];
+
+    // Frames rendered and their average render time since the last sample
+    uint32_t now = lv_tick_get();
+    uint32_t elapsedMs = lv_tick_diff(now, _lastSampleMs);
+    _lastSampleMs = now;
+    uint32_t fps = elapsedMs > 0 ? (_frames * 1000 + elapsedMs / 2) / elapsedMs : 0;
+    uint32_t renderUs = _frames > 0 ? _renderTotalUs / _frames : 0;
+    _frames = 0;
+    _renderTotalUs = 0;
+
+    snprintf(text, sizeof(text), "%lu fps  %lu.%lu ms",
+             (unsigned long)fps, (unsigned long)(renderUs / 1000), (unsigned long)(renderUs / 100 % 10));
+    setLabelText(_frameLabel, text);
+    if (_frameSeries) {
+        lv_chart_set_next_value(_frameChart, _frameSeries, renderUs / 1000);
+    }
+
+    uint8_t load[2] = {0, 0};
+    if (sampleCpuLoad(load)) {
+        snprintf(text, sizeof(text), "CPU %u%% / %u%%", load[0], load[1]);
+        for (int core = 0; core < 2; core++) {
+            if (_cpuSeries[core]) {
+                lv_chart_set_next_value(_cpuChart, _cpuSeries[core], load[core]);
+            }
+        }
+    } else {
+        snprintf(text, sizeof(text), "CPU --");
+    }
+    setLabelText(_cpuLabel, text);
+
+    snprintf(text, sizeof(text), "RAM %uK  PSRAM %uK",
+             (unsigned)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024),
+             (unsigned)(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024));
+    setLabelText(_heapLabel, text);
+
+    EventQueue::Stats events = _eventQueue.getStats();
+    UIDispatchQueue::Stats ui = CardController::getUIQueueStats();
+    snprintf(text, sizeof(text), "Events %u/%u  UI %u",
+             (unsigned)events.inUse, (unsigned)events.capacity, (unsigned)ui.pending);
+    setLabelText(_queueLabel, text);
+}
+
+bool PerformanceCard::sampleCpuLoad(uint8_t load[2]) {
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    _taskStatus.resize(uxTaskGetNumberOfTasks() + 4);
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(_taskStatus.data(), _taskStatus.size(), &totalRunTime);
+    if (count == 0) {
+        return false;
+    }
+
+    uint32_t totalDelta = totalRunTime - _lastTotalRunTime;
+    _lastTotalRunTime = totalRunTime;
+
+    for (int core = 0; core < 2; core++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+        for (UBaseType_t i = 0; i < count; i++) {
+            if (_taskStatus[i].xHandle != idle) {
+                continue;
+            }
+            uint32_t idleDelta = _taskStatus[i].ulRunTimeCounter - _lastIdleRunTime[core];
+            _lastIdleRunTime[core] = _taskStatus[i].ulRunTimeCounter;
+            if (load) {
+                uint32_t idlePercent = totalDelta > 0 ? (uint64_t)idleDelta * 100 / totalDelta : 100;
+                load[core] = idlePercent >= 100 ? 0 : 100 - idlePercent;
+            }
+            break;
+        }
+    }
+    return true;
+#else
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t elapsedUs = now - _lastTotalRunTime;
+    _lastTotalRunTime = now;
+    if (elapsedUs == 0) {
+        return false;
+    }
+
+    for (int core = 0; core < 2; core++) {
+        uint32_t calls = idleCalls[core];
+        uint32_t idleDelta = calls - _lastIdleRunTime[core];
+        _lastIdleRunTime[core] = calls;
+
+        uint32_t rate = (uint64_t)idleDelta * 1000000 / elapsedUs;
+        if (rate > _peakIdleRate[core]) {
+            _peakIdleRate[core] = rate;
+        }
+        if (load) {
+            uint32_t idlePercent = _peakIdleRate[core] > 0 ? (uint64_t)rate * 100 / _peakIdleRate[core] : 100;
+            load[core] = idlePercent >= 100 ? 0 : 100 - idlePercent;
+        }
+    }
+    return true;
+#endif
+}
+
+void PerformanceCard::sampleTimerCallback(lv_timer_t* timer) {
+    PerformanceCard* card = static_cast<PerformanceCard*>(lv_timer_get_user_data(timer));
+    card->sample();
+}
+
+void PerformanceCard::renderEventCallback(lv_event_t* event) {
+    PerformanceCard* card = static_cast<PerformanceCard*>(lv_event_get_user_data(event));
+    if (!card->_active) {
+        return;
+    }
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    if (lv_event_get_code(event) == LV_EVENT_RENDER_START) {
+        card->_renderStartUs = now;
+    } else {
+        card->_renderTotalUs += now - card->_renderStartUs;
+        card->_frames++;
+    }
+}
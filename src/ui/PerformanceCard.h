@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "ui/InputHandler.h"
+#include "EventQueue.h"
+
+/**
+ * @class PerformanceCard
+ * @brief On-device HUD of render, CPU, memory and queue health
+ *
+ * Shows frames per second and average render time, per-core CPU load,
+ * free internal RAM and PSRAM, and the depth of the event and UI queues,
+ * with sparklines of render time and CPU load.
+ *
+ * An LVGL timer samples once per SAMPLE_PERIOD_MS on the LVGL task, so no
+ * cross-task dispatch is needed. The timer only runs while the card is on
+ * screen (see setActive). Labels are only rewritten when their text
+ * changes, and a sparkline redraws once per sample. Render time comes from
+ * the display's render start/ready events.
+ *
+ * CPU load comes from FreeRTOS run time stats when the core was built with
+ * configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY. Otherwise it
+ * is estimated from idle hook calls per second against the highest rate
+ * seen, which reads low until the card has seen the device mostly idle.
+ */
+class PerformanceCard : public InputHandler {
+public:
+    static constexpr uint32_t SAMPLE_PERIOD_MS = 1000;   ///< Time between samples
+    static constexpr uint16_t HISTORY_POINTS = 30;       ///< Samples shown by each sparkline
+
+    /**
+     * @param parent LVGL parent object
+     * @param eventQueue Event queue whose depth is shown
+     */
+    PerformanceCard(lv_obj_t* parent, EventQueue& eventQueue);
+
+    /**
+     * @brief Stops sampling and schedules async deletion of the card
+     */
+    ~PerformanceCard();
+
+    /**
+     * @brief Get the underlying LVGL card object
+     * @return LVGL object pointer or nullptr if not created
+     */
+    lv_obj_t* getCard() const { return _card; }
+
+    /**
+     * @brief Start or stop sampling as the card comes on or goes off screen
+     * @param active Whether this card is the one being shown
+     */
+    void setActive(bool active);
+
+    bool handleButtonPress(uint8_t button_index) override;
+    void prepareForRemoval() override { _card = nullptr; }
+
+private:
+    /**
+     * @brief Create a sparkline chart
+     * @param y Offset from the top of the card
+     * @param max Top of the Y range
+     */
+    lv_obj_t* createSparkline(int16_t y, int32_t max);
+
+    /**
+     * @brief Create a row label
+     * @param y Offset from the top of the card
+     */
+    lv_obj_t* createLabel(int16_t y);
+
+    /**
+     * @brief Set a label's text only if it changed, to avoid a redraw
+     */
+    static void setLabelText(lv_obj_t* label, const char* text);
+
+    /**
+     * @brief Take a sample and update the labels and sparklines
+     */
+    void sample();
+
+    /**
+     * @brief Measure per-core load since the previous sample
+     * @param load Receives each core's busy percentage, or nullptr to only
+     *             take a baseline
+     * @return false if no load could be measured
+     */
+    bool sampleCpuLoad(uint8_t load[2]);
+
+    static void sampleTimerCallback(lv_timer_t* timer);
+    static void renderEventCallback(lv_event_t* event);
+
+    EventQueue& _eventQueue;
+
+    lv_obj_t* _card;
+    lv_obj_t* _frameLabel;       ///< FPS and average render time
+    lv_obj_t* _cpuLabel;         ///< Load per core
+    lv_obj_t* _heapLabel;        ///< Free internal RAM and PSRAM
+    lv_obj_t* _queueLabel;       ///< Event and UI queue depths
+    lv_obj_t* _frameChart;
+    lv_obj_t* _cpuChart;
+    lv_chart_series_t* _frameSeries;
+    lv_chart_series_t* _cpuSeries[2];  ///< One line per core
+    lv_timer_t* _timer;
+    lv_display_t* _display;
+    bool _active;                ///< Whether the card is on screen and sampling
+
+    // Render timing, written by the display events between samples
+    uint32_t _renderStartUs;
+    uint32_t _frames;
+    uint32_t _renderTotalUs;
+    uint32_t _lastSampleMs;
+
+    // Idle task run time (or idle hook calls) at the previous sample, per core
+    uint32_t _lastIdleRunTime[2];
+    uint32_t _lastTotalRunTime;  ///< Total run time, or esp_timer time in us
+    uint32_t _peakIdleRate[2];   ///< Most idle hook calls per second seen, per core
+    std::vector<TaskStatus_t> _taskStatus;
+};
@@ -1,22 +1,17 @@
 #ifndef UI_CALLBACK_H
 #define UI_CALLBACK_H
 
-#include <functional>
+#include <stdint.h>
+#include "InlineFunction.h"
 
-// Helper class for memory-safe UI callbacks, typically for LVGL operations
-class UICallback {
-public:
-    UICallback(std::function<void()> func) : _func(std::move(func)) {}
-    
-    void execute() {
-        if (_func) {
-            _func();
-        }
-    }
-    
-private:
-    std::function<void()> _func;
-};
+/**
+ * @brief Work handed to the LVGL thread
+ *
+ * Captures are stored inline, so dispatching never allocates. The largest
+ * dispatch today captures `this`, a double and two Strings; a lambda that
+ * outgrows this fails to compile.
+ */
+using UITask = InlineFunction<void(), 64>;
 
 /**
  * @brief Global UI dispatch function
@@ -27,6 +22,36 @@ private:
  * @param func The function to execute on the UI thread
  * @param to_front Whether to add to front of queue (higher priority)
  */
-extern std::function<void(std::function<void()>, bool)> globalUIDispatch;
+extern InlineFunction<void(UITask, bool), 16> globalUIDispatch;
+
+/**
+ * @brief Identifies an update that supersedes earlier pending ones
+ *
+ * While an update is waiting for the LVGL thread, dispatching another with
+ * the same owner and kind replaces it, so only the latest one runs.
+ */
+struct UIUpdateKey {
+    const void* owner;   ///< Object the update belongs to, e.g. a renderer
+    uint8_t kind;        ///< Which of the owner's updates this is
+};
+
+/**
+ * @brief Global keyed UI dispatch function
+ *
+ * Set by CardController alongside globalUIDispatch.
+ *
+ * @param key Update key; a pending update with the same key is replaced
+ * @param func The function to execute on the UI thread
+ */
+extern InlineFunction<void(const UIUpdateKey&, UITask), 16> globalUIDispatchKeyed;
+
+/**
+ * @brief Global cancel function for keyed UI updates
+ *
+ * Owners call this as they are destroyed so no pending update runs against them.
+ *
+ * @param owner Owner passed in the updates' keys
+ */
+extern InlineFunction<void(const void*), 16> globalUICancel;
 
-#endif // UI_CALLBACK_H 
\ No newline at end of file
+#endif // UI_CALLBACK_H
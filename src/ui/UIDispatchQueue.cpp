@@ -0,0 +1,171 @@
+#include "UIDispatchQueue.h"
+#include <algorithm>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+UIDispatchQueue::UIDispatchQueue()
+    : _keyed()
+    , _keyedMutex(xSemaphoreCreateMutex())
+    , _keyedSeq(0)
+    , _keyedPending(0)
+    , _keyedDispatched(0)
+    , _coalesced(0) {
+    if (_keyedMutex == nullptr) {
+        Serial.println("[UIDispatchQueue] Failed to create keyed update mutex, keyed updates won't coalesce");
+    }
+}
+
+UIDispatchQueue::~UIDispatchQueue() {
+    if (_keyedMutex != nullptr) {
+        vSemaphoreDelete(_keyedMutex);
+    }
+}
+
+bool UIDispatchQueue::push(UITask&& func, bool urgent) {
+    // No other task can run on this core until we resume, so this task is
+    // the rings' only producer; it also can't migrate mid-push
+    vTaskSuspendAll();
+    size_t core = (size_t)xPortGetCoreID() % CORE_COUNT;
+    bool queued = urgent ? _urgent[core].push(std::move(func)) : _normal[core].push(std::move(func));
+    xTaskResumeAll();
+    return queued;
+}
+
+bool UIDispatchQueue::pushKeyed(const UIUpdateKey& key, UITask&& func) {
+    if (_keyedMutex == nullptr) {
+        return push(std::move(func), false);
+    }
+
+    // The superseded update is destroyed after the lock is released
+    UITask superseded;
+
+    xSemaphoreTake(_keyedMutex, portMAX_DELAY);
+    KeyedSlot* target = nullptr;
+    KeyedSlot* vacant = nullptr;
+    for (auto& slot : _keyed) {
+        if (slot.pending && slot.key.owner == key.owner && slot.key.kind == key.kind) {
+            target = &slot;
+            break;
+        }
+        if (!slot.pending && vacant == nullptr) {
+            vacant = &slot;
+        }
+    }
+
+    if (target != nullptr) {
+        superseded = std::move(target->task);
+        _coalesced.fetch_add(1, std::memory_order_relaxed);
+    } else if (vacant != nullptr) {
+        target = vacant;
+        target->key = key;
+        target->pending = true;
+        _keyedPending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (target != nullptr) {
+        target->task = std::move(func);
+        target->seq = _keyedSeq++;
+    }
+    xSemaphoreGive(_keyedMutex);
+
+    // Table full: still deliver the update, just without coalescing
+    return target != nullptr || push(std::move(func), false);
+}
+
+void UIDispatchQueue::cancel(const void* owner) {
+    if (_keyedMutex == nullptr || owner == nullptr) {
+        return;
+    }
+
+    xSemaphoreTake(_keyedMutex, portMAX_DELAY);
+    for (auto& slot : _keyed) {
+        if (slot.pending && slot.key.owner == owner) {
+            slot.task.reset();
+            slot.pending = false;
+            _keyedPending.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    xSemaphoreGive(_keyedMutex);
+}
+
+size_t UIDispatchQueue::drainKeyed() {
+    if (_keyedMutex == nullptr || _keyedPending.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+
+    xSemaphoreTake(_keyedMutex, portMAX_DELAY);
+    uint32_t end = _keyedSeq;
+    xSemaphoreGive(_keyedMutex);
+
+    for (auto& slot : _keyed) {
+        // Take the update out so it runs unlocked and a push it makes gets a fresh slot
+        UITask task;
+        xSemaphoreTake(_keyedMutex, portMAX_DELAY);
+        if (slot.pending && (int32_t)(slot.seq - end) < 0) {
+            task = std::move(slot.task);
+            slot.pending = false;
+            _keyedPending.fetch_sub(1, std::memory_order_relaxed);
+        }
+        xSemaphoreGive(_keyedMutex);
+
+        if (task) {
+            task();
+            count++;
+        }
+    }
+
+    _keyedDispatched.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+size_t UIDispatchQueue::drain() {
+    size_t count = 0;
+
+    for (auto& ring : _urgent) {
+        for (size_t i = ring.size(); i > 0 && ring.runOne(); i--) {
+            count++;
+        }
+    }
+    for (auto& ring : _normal) {
+        for (size_t i = ring.size(); i > 0 && ring.runOne(); i--) {
+            count++;
+        }
+    }
+    count += drainKeyed();
+
+    return count;
+}
+
+bool UIDispatchQueue::empty() const {
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        if (_urgent[core].size() > 0 || _normal[core].size() > 0) {
+            return false;
+        }
+    }
+    return _keyedPending.load(std::memory_order_relaxed) == 0;
+}
+
+UIDispatchQueue::Stats UIDispatchQueue::getStats() const {
+    Stats stats = {};
+    for (const auto& ring : _urgent) {
+        stats.capacity += ring.capacity();
+        stats.pending += ring.size();
+        stats.highWater = std::max(stats.highWater, ring.highWater());
+        stats.dispatched += ring.dispatched();
+        stats.dropped += ring.dropped();
+    }
+    for (const auto& ring : _normal) {
+        stats.capacity += ring.capacity();
+        stats.pending += ring.size();
+        stats.highWater = std::max(stats.highWater, ring.highWater());
+        stats.dispatched += ring.dispatched();
+        stats.dropped += ring.dropped();
+    }
+    stats.capacity += KEYED_CAPACITY;
+    stats.pending += _keyedPending.load(std::memory_order_relaxed);
+    stats.dispatched += _keyedDispatched.load(std::memory_order_relaxed);
+    stats.coalesced = _coalesced.load(std::memory_order_relaxed);
+    return stats;
+}
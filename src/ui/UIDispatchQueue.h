@@ -0,0 +1,244 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "UICallback.h"
+
+/**
+ * @class InlineCallbackRing
+ * @brief Single-producer, single-consumer ring of callables stored in place
+ *
+ * Each slot holds the callable itself plus two function pointers to run and
+ * destroy it, so pushing and running never touch the heap. Callables that
+ * don't fit a slot fail to compile rather than falling back to allocation.
+ *
+ * @tparam SlotSize Bytes of inline storage per slot
+ * @tparam Capacity Number of slots, a power of two
+ */
+template <size_t SlotSize, size_t Capacity>
+class InlineCallbackRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Ring capacity must be a power of two");
+
+public:
+    InlineCallbackRing() : _head(0), _tail(0), _highWater(0), _dispatched(0), _dropped(0) {}
+
+    // Pending callables may refer to owners that are already gone; drop them unrun
+    ~InlineCallbackRing() {
+        while (discardOne()) {
+        }
+    }
+
+    // Slots hold live objects; the ring can't be copied
+    InlineCallbackRing(const InlineCallbackRing&) = delete;
+    InlineCallbackRing& operator=(const InlineCallbackRing&) = delete;
+
+    /**
+     * @brief Move a callable into the next free slot (producer only)
+     * @param func Callable taking no arguments
+     * @return false if the ring is full; the callable is dropped and counted
+     */
+    template <typename F>
+    bool push(F&& func) {
+        using Fn = typename std::decay<F>::type;
+        static_assert(sizeof(Fn) <= SlotSize, "Callable does not fit a UI dispatch slot");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable is over-aligned for a UI dispatch slot");
+
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t used = head - _tail.load(std::memory_order_acquire);
+        if (used >= Capacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Slot& slot = _slots[head & (Capacity - 1)];
+        new (slot.storage) Fn(std::forward<F>(func));
+        slot.invoke = [](void* storage) { (*static_cast<Fn*>(storage))(); };
+        slot.destroy = [](void* storage) { static_cast<Fn*>(storage)->~Fn(); };
+        _head.store(head + 1, std::memory_order_release);
+
+        if (used + 1 > _highWater.load(std::memory_order_relaxed)) {
+            _highWater.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run and destroy the oldest callable (consumer only)
+     * @return false if the ring was empty
+     *
+     * The slot stays claimed while the callable runs, so the producer can't
+     * overwrite it even if the callable dispatches more work.
+     */
+    bool runOne() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        Slot& slot = _slots[tail & (Capacity - 1)];
+        slot.invoke(slot.storage);
+        slot.destroy(slot.storage);
+        _tail.store(tail + 1, std::memory_order_release);
+        _dispatched.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Destroy the oldest callable without running it (consumer only)
+     * @return false if the ring was empty
+     */
+    bool discardOne() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        Slot& slot = _slots[tail & (Capacity - 1)];
+        slot.destroy(slot.storage);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+    size_t highWater() const { return _highWater.load(std::memory_order_relaxed); }
+    uint32_t dispatched() const { return _dispatched.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        alignas(std::max_align_t) unsigned char storage[SlotSize];
+        void (*invoke)(void*);
+        void (*destroy)(void*);
+    };
+
+    Slot _slots[Capacity];
+    std::atomic<uint32_t> _head;        ///< Next slot to fill, written by the producer
+    std::atomic<uint32_t> _tail;        ///< Next slot to run, written by the consumer
+    std::atomic<size_t> _highWater;     ///< Most slots ever in use at once
+    std::atomic<uint32_t> _dispatched;  ///< Callables run
+    std::atomic<uint32_t> _dropped;     ///< Callables rejected because the ring was full
+};
+
+/**
+ * @class UIDispatchQueue
+ * @brief Allocation-free hand-off of UI work to the LVGL task
+ *
+ * One InlineCallbackRing per producer core and lane. A producer suspends
+ * the scheduler on its own core while pushing, which makes it the only
+ * writer of that core's rings without a cross-core lock. The LVGL task is
+ * the single consumer and runs the urgent lane of both cores first.
+ *
+ * Updates pushed with a UIUpdateKey go to a small keyed table instead: a
+ * newer update for the same key replaces the pending one, so a busy LVGL
+ * task never runs stale redraws back to back.
+ */
+class UIDispatchQueue {
+public:
+    /**
+     * @brief Ring usage across cores and lanes
+     */
+    struct Stats {
+        size_t capacity;       ///< Slots across all rings
+        size_t pending;        ///< Callables waiting to run
+        size_t highWater;      ///< Fullest any single ring has been
+        uint32_t dispatched;   ///< Callables run since boot
+        uint32_t dropped;      ///< Callables discarded because their ring was full
+        uint32_t coalesced;    ///< Keyed updates replaced by a newer one before running
+    };
+
+    UIDispatchQueue();
+    ~UIDispatchQueue();
+
+    UIDispatchQueue(const UIDispatchQueue&) = delete;
+    UIDispatchQueue& operator=(const UIDispatchQueue&) = delete;
+
+    /**
+     * @brief Queue work for the LVGL task
+     * @param func Work to run on the LVGL task
+     * @param urgent Run ahead of normal work (e.g. tearing down a card)
+     * @return false if the ring for this core and lane was full
+     */
+    bool push(UITask&& func, bool urgent);
+
+    /**
+     * @brief Queue an update that replaces any pending one with the same key
+     * @param key Owner and kind of the update
+     * @param func Work to run on the LVGL task
+     * @return false if the update was dropped
+     *
+     * When the keyed table is full the update falls back to the normal lane.
+     */
+    bool pushKeyed(const UIUpdateKey& key, UITask&& func);
+
+    /**
+     * @brief Discard pending keyed updates of an owner that is going away
+     * @param owner Owner passed in the updates' keys
+     */
+    void cancel(const void* owner);
+
+    /**
+     * @brief Run queued work (LVGL task only)
+     * @return Number of callables run
+     *
+     * Urgent work runs first, then normal work, then keyed updates, so an
+     * update sees the structure that earlier work built.
+     *
+     * Work queued by the callables themselves waits for the next call, so
+     * a callback that re-dispatches can't keep the LVGL task here forever.
+     */
+    size_t drain();
+
+    /**
+     * @brief Check whether any work is waiting
+     */
+    bool empty() const;
+
+    /**
+     * @brief Get usage counters
+     */
+    Stats getStats() const;
+
+    static constexpr size_t URGENT_CAPACITY = 8;    ///< Slots per core for urgent work
+    static constexpr size_t NORMAL_CAPACITY = 32;   ///< Slots per core for normal work
+    static constexpr size_t KEYED_CAPACITY = 16;    ///< Distinct keys pending at once
+    static constexpr size_t SLOT_SIZE = sizeof(UITask); ///< Inline bytes per slot
+
+private:
+    static constexpr size_t CORE_COUNT = 2;
+
+    InlineCallbackRing<SLOT_SIZE, URGENT_CAPACITY> _urgent[CORE_COUNT];
+    InlineCallbackRing<SLOT_SIZE, NORMAL_CAPACITY> _normal[CORE_COUNT];
+
+    /**
+     * @brief Latest pending update for one key
+     */
+    struct KeyedSlot {
+        UIUpdateKey key;
+        uint32_t seq;          ///< Order of the latest push, bounds each drain
+        bool pending;
+        UITask task;
+    };
+
+    /**
+     * @brief Run keyed updates pushed before this drain started
+     * @return Number of updates run
+     */
+    size_t drainKeyed();
+
+    KeyedSlot _keyed[KEYED_CAPACITY];
+    SemaphoreHandle_t _keyedMutex;           ///< Guards _keyed and _keyedSeq
+    uint32_t _keyedSeq;                      ///< Next keyed push sequence number
+    std::atomic<size_t> _keyedPending;       ///< Slots with a pending update
+    std::atomic<uint32_t> _keyedDispatched;  ///< Keyed updates run
+    std::atomic<uint32_t> _coalesced;        ///< Keyed updates superseded before running
+};
@@ -57,14 +57,13 @@ void FunnelRenderer::createElements(lv_obj_t* parent_container) {
     lv_obj_set_style_border_width(_funnel_main_container, 0, 0);
     lv_obj_set_style_bg_opa(_funnel_main_container, LV_OPA_0, 0); // Transparent background
 
-    lv_coord_t available_width = lv_obj_get_content_width(_funnel_main_container);
-
+    // Widths are set in onLayoutReady, once the main container has been laid out
     for (int i = 0; i < MAX_FUNNEL_STEPS; ++i) {
         // Create bar container (a simple object to hold segments)
         _funnel_step_bars[i] = lv_obj_create(_funnel_main_container);
         if (!_funnel_step_bars[i]) continue; // Error handling: skip if creation fails
         
-        lv_obj_set_size(_funnel_step_bars[i], available_width, FUNNEL_BAR_HEIGHT);
+        lv_obj_set_height(_funnel_step_bars[i], FUNNEL_BAR_HEIGHT);
         lv_obj_set_style_bg_opa(_funnel_step_bars[i], LV_OPA_0, 0); // Transparent bar container
         lv_obj_set_style_border_width(_funnel_step_bars[i], 0, 0);
         lv_obj_set_style_pad_all(_funnel_step_bars[i], 0, 0);
@@ -78,7 +77,6 @@ void FunnelRenderer::createElements(lv_obj_t* parent_container) {
         lv_obj_set_style_text_color(_funnel_step_labels[i], Style::valueColor(), 0);
         lv_obj_set_style_text_font(_funnel_step_labels[i], Style::valueFont(), 0);
         lv_label_set_long_mode(_funnel_step_labels[i], LV_LABEL_LONG_DOT);
-        lv_obj_set_width(_funnel_step_labels[i], available_width);
         lv_obj_set_height(_funnel_step_labels[i], FUNNEL_LABEL_HEIGHT);
         lv_obj_add_flag(_funnel_step_labels[i], LV_OBJ_FLAG_HIDDEN); // Initially hidden
 
@@ -98,6 +96,22 @@ void FunnelRenderer::createElements(lv_obj_t* parent_container) {
     // Serial.println("[FunnelRenderer] Funnel elements created successfully.");
 }
 
+void FunnelRenderer::onLayoutReady() {
+    if (!isValidLVGLObject(_funnel_main_container)) {
+        return;
+    }
+
+    lv_coord_t available_width = lv_obj_get_content_width(_funnel_main_container);
+    for (int i = 0; i < MAX_FUNNEL_STEPS; ++i) {
+        if (_funnel_step_bars[i]) {
+            lv_obj_set_width(_funnel_step_bars[i], available_width);
+        }
+        if (_funnel_step_labels[i]) {
+            lv_obj_set_width(_funnel_step_labels[i], available_width);
+        }
+    }
+}
+
 void FunnelRenderer::updateDisplay(InsightParser& parser, const String& title_str, const char* prefix, const char* suffix) {
     // prefix and suffix are ignored for FunnelRenderer.
     Serial.printf("[FunnelRenderer] updateDisplay for title: %s\n", title_str.c_str()); // Verify this is called
@@ -115,7 +129,7 @@ void FunnelRenderer::updateDisplay(InsightParser& parser, const String& title_st
     if (step_count == 0) {
         Serial.println("[FunnelRenderer] step_count is 0, hiding elements.");
         // No steps, clear display or show message
-        dispatchToUI([this]() {
+        dispatchUpdateToUI(UPDATE_DISPLAY, [this]() {
             if (!areElementsValid()) return;
             for (int i = 0; i < MAX_FUNNEL_STEPS; ++i) {
                 if (isValidLVGLObject(_funnel_step_bars[i])) lv_obj_add_flag(_funnel_step_bars[i], LV_OBJ_FLAG_HIDDEN);
@@ -217,7 +231,7 @@ void FunnelRenderer::updateDisplay(InsightParser& parser, const String& title_st
     }
 
     // Dispatch UI update
-    dispatchToUI([this, captured_steps_data = std::move(ui_steps_data), step_count, breakdown_count, available_width_for_bars]() {
+    dispatchUpdateToUI(UPDATE_DISPLAY, [this, captured_steps_data = std::move(ui_steps_data), step_count, breakdown_count, available_width_for_bars]() {
         if (!areElementsValid()) {
             Serial.println("[FunnelRenderer-WARN] Funnel elements invalid in updateDisplay lambda.");
             return;
@@ -271,13 +285,7 @@ void FunnelRenderer::updateDisplay(InsightParser& parser, const String& title_st
             if (isValidLVGLObject(_funnel_step_bars[i])) lv_obj_add_flag(_funnel_step_bars[i], LV_OBJ_FLAG_HIDDEN);
             if (isValidLVGLObject(_funnel_step_labels[i])) lv_obj_add_flag(_funnel_step_labels[i], LV_OBJ_FLAG_HIDDEN);
         }
-        
-        // Optional: force refresh
-        // lv_obj_invalidate(_funnel_main_container); // Invalidate the specific container
-        // lv_display_t* disp = lv_display_get_default();
-        // if (disp) { lv_refr_now(disp); }
-
-    }, true); // Send to front for responsiveness
+    });
 }
 
 void FunnelRenderer::clearElements() {
@@ -12,6 +12,7 @@ public:
     ~FunnelRenderer() override;
 
     void createElements(lv_obj_t* parent_container) override;
+    void onLayoutReady() override;
     void updateDisplay(InsightParser& parser, const String& title, const char* prefix = nullptr, const char* suffix = nullptr) override;
     void clearElements() override;
     bool areElementsValid() const override;
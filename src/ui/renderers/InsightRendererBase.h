@@ -4,7 +4,6 @@
 #include "lvgl.h"
 #include "../../posthog/parsers/InsightParser.h" // Adjusted path
 #include <Arduino.h> // For String, if used in titles or other data
-#include <functional> // For std::function
 
 #include "../UICallback.h" // For global dispatch function
 
@@ -15,25 +14,28 @@
  * Defines the interface for creating, updating, and clearing UI elements 
  * for a specific insight visualization.
  *
- * **Important LVGL Rendering Lifecycle Note:**
- * When implementing a new renderer, be aware of LVGL's rendering and layout lifecycle.
- * LVGL may not immediately calculate the final dimensions and positions of newly created 
- * objects (especially when using flexbox or percentage-based sizing in parent containers)
- * within the same execution cycle as their creation.
+ * **Important LVGL Layout Lifecycle Note:**
+ * LVGL doesn't calculate the final dimensions and positions of newly created
+ * objects (especially with flexbox or percentage-based sizing) until the
+ * layout is updated, which normally happens just before the next render.
  *
- * If a renderer's `updateDisplay` method relies on the final, calculated dimensions of 
- * elements just created in its `createElements` method (e.g., to size or position 
- * children accurately), it's crucial to ensure LVGL has processed these layouts.
- * In the `InsightCard` (which manages these renderers), a forced refresh 
- * (e.g., `lv_obj_invalidate()` on the container followed by `lv_refr_now()`) 
- * is performed *between* calling `createElements()` and `updateDisplay()`.
- * This allows `updateDisplay()` to work with more reliable, up-to-date element dimensions.
- * Failure to account for this can lead to elements appearing incorrectly sized, 
- * misplaced, or not appearing until a later, unrelated refresh cycle.
+ * `InsightCard` updates the layout of the parent container before calling
+ * `createElements()`, so the container's own size can be read there. It
+ * updates it again afterwards and calls `onLayoutReady()`, where the sizes of
+ * the elements just created are final. Size anything that depends on them
+ * there (or in `updateDisplay()`), not in `createElements()`.
+ *
+ * Nothing forces a render: the new elements are drawn on the next regular
+ * refresh, so rebuilding a card never stalls the display.
  */
 class InsightRendererBase {
 public:
-    virtual ~InsightRendererBase() = default;
+    virtual ~InsightRendererBase() {
+        // Drop display updates still waiting to run against this renderer
+        if (globalUICancel) {
+            globalUICancel(this);
+        }
+    }
 
     /**
      * @brief Creates the specific UI elements for this insight type.
@@ -44,6 +46,12 @@ public:
      */
     virtual void createElements(lv_obj_t* parent_container) = 0;
 
+    /**
+     * @brief Called on the LVGL UI thread once the elements from `createElements`
+     * have been laid out, so their sizes and positions are final.
+     */
+    virtual void onLayoutReady() {}
+
     /**
      * @brief Updates the display with new data from the parser.
      * This method will be called when new data for the insight is received.
@@ -72,7 +80,7 @@ public:
 
 protected:
     // Helper to dispatch UI updates to the LVGL task using global dispatch function
-    static void dispatchToUI(std::function<void()> func, bool to_front = false) {
+    static void dispatchToUI(UITask func, bool to_front = false) {
         if (globalUIDispatch) {
             globalUIDispatch(std::move(func), to_front);
         } else {
@@ -80,6 +88,20 @@ protected:
         }
     }
 
+    // Kinds of keyed update a renderer dispatches; a newer one replaces a pending one
+    enum UpdateKind : uint8_t {
+        UPDATE_DISPLAY
+    };
+
+    // Helper to dispatch an update that supersedes any pending update of the same kind
+    void dispatchUpdateToUI(UpdateKind kind, UITask func) {
+        if (globalUIDispatchKeyed) {
+            globalUIDispatchKeyed(UIUpdateKey{this, kind}, std::move(func));
+        } else {
+            dispatchToUI(std::move(func));
+        }
+    }
+
     // Helper to check LVGL object validity (can be used by derived classes)
     static bool isValidLVGLObject(lv_obj_t* obj) {
         return obj && lv_obj_is_valid(obj);
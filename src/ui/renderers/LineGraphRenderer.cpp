@@ -1,6 +1,7 @@
 #include "LineGraphRenderer.h"
 #include <memory> // For std::unique_ptr for data arrays
 #include <algorithm> // For std::min
+#include <vector>
 
 LineGraphRenderer::LineGraphRenderer()
     : _chart(nullptr), _series(nullptr) {
@@ -52,9 +53,7 @@ void LineGraphRenderer::createElements(lv_obj_t* parent_container) {
     lv_obj_set_style_size(_chart, 0, 0, LV_PART_INDICATOR); // No indicators (dots on points)
     lv_obj_set_style_line_width(_chart, 2, LV_PART_ITEMS); // Line width for the series
 
-    // Initial refresh of the chart might be good if it has default state
-    // lv_chart_refresh(_chart);
-    // InsightCard will do a global refresh after calling createElements if needed.
+    // The chart is drawn on the next regular refresh; nothing to force here
 }
 
 void LineGraphRenderer::updateDisplay(InsightParser& parser, const String& title, const char* prefix, const char* suffix) {
@@ -64,7 +63,7 @@ void LineGraphRenderer::updateDisplay(InsightParser& parser, const String& title
     if (point_count == 0) {
         // No data points, maybe clear the chart or show a message?
         // For now, clear existing points if any.
-        dispatchToUI([this]() {
+        dispatchUpdateToUI(UPDATE_DISPLAY, [this]() {
             if (isValidLVGLObject(_chart) && _series) {
                 lv_chart_set_point_count(_chart, 0);
                 lv_chart_refresh(_chart);
@@ -106,7 +105,7 @@ void LineGraphRenderer::updateDisplay(InsightParser& parser, const String& title
         values_for_lambda[i] = y_values_from_parser[i];
     }
 
-    dispatchToUI([this, captured_values = std::move(values_for_lambda), point_count, max_val, scale_factor]() {
+    dispatchUpdateToUI(UPDATE_DISPLAY, [this, captured_values = std::move(values_for_lambda), point_count, max_val, scale_factor]() {
         if (!areElementsValid()) {
             Serial.println("[LineGraphRenderer-WARN] Chart/Series invalid in updateDisplay lambda.");
             return;
@@ -133,11 +132,7 @@ void LineGraphRenderer::updateDisplay(InsightParser& parser, const String& title
         lv_chart_set_range(_chart, LV_CHART_AXIS_PRIMARY_Y, 0, static_cast<int32_t>(max_val * scale_factor * 1.1));
         
         lv_chart_refresh(_chart);
-
-        // Optional: Force a global display refresh if needed, though InsightCard might handle it.
-        // lv_display_t* disp = lv_display_get_default();
-        // if (disp) { lv_refr_now(disp); }
-    }, true); // Send to front to prioritize data update rendering
+    });
 }
 
 void LineGraphRenderer::clearElements() {
@@ -46,7 +46,7 @@ void NumericCardRenderer::updateDisplay(InsightParser& parser, const String& tit
 
     // Data processing (getting value) is done here.
     // LVGL operations are dispatched to the UI thread.
-    dispatchToUI([this, value, p = String(prefix ? prefix : ""), s = String(suffix ? suffix : "")]() {
+    dispatchUpdateToUI(UPDATE_DISPLAY, [this, value, p = String(prefix ? prefix : ""), s = String(suffix ? suffix : "")]() {
         // Serial.printf("[NumericRenderer] Updating display on UI thread. Label: %p, Core: %d\n", _value_label, xPortGetCoreID());
         if (isValidLVGLObject(_value_label)) {
             char numeric_buffer[32];
@@ -60,9 +60,6 @@ void NumericCardRenderer::updateDisplay(InsightParser& parser, const String& tit
         } else {
             Serial.println("[NumericRenderer-WARN] _value_label invalid in updateDisplay lambda.");
         }
-        // Optional: force refresh if this specific update needs it immediately.
-        // lv_display_t* disp = lv_display_get_default();
-        // if (disp) { lv_refr_now(disp); }
     });
 }
 
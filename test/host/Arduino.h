@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core, for the native env
+ *
+ * Covers only what the sources built by the native env use: String, Serial,
+ * timing, the ESP heap queries and no-op pin functions. Like the device's
+ * core, it brings in FreeRTOS.
+ */
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define CHANGE 0x03
+
+/**
+ * @brief Arduino String with the same layout cost as the device's
+ *
+ * Kept to a pointer and two lengths so lambdas capturing Strings fit the
+ * same InlineFunction capacities they do on the device.
+ */
+class String {
+public:
+    String() : _buffer(nullptr), _length(0), _capacity(0) {}
+    String(const char* cstr) : String() { if (cstr) assign(cstr, strlen(cstr)); }
+    String(const String& other) : String() { assign(other.c_str(), other._length); }
+    String(String&& other) noexcept : _buffer(other._buffer), _length(other._length), _capacity(other._capacity) {
+        other._buffer = nullptr;
+        other._length = 0;
+        other._capacity = 0;
+    }
+    explicit String(char c) : String() { assign(&c, 1); }
+    explicit String(int value, unsigned char base = 10) : String() { assignFormatted(base == 16 ? "%x" : "%d", value); }
+    explicit String(unsigned int value, unsigned char base = 10) : String() { assignFormatted(base == 16 ? "%x" : "%u", value); }
+    explicit String(long value, unsigned char base = 10) : String() { assignFormatted(base == 16 ? "%lx" : "%ld", value); }
+    explicit String(unsigned long value, unsigned char base = 10) : String() { assignFormatted(base == 16 ? "%lx" : "%lu", value); }
+    explicit String(double value, unsigned int decimalPlaces = 2) : String() { assignFormatted("%.*f", (int)decimalPlaces, value); }
+    explicit String(float value, unsigned int decimalPlaces = 2) : String((double)value, decimalPlaces) {}
+    ~String() { free(_buffer); }
+
+    String& operator=(const String& other) {
+        if (this != &other) assign(other.c_str(), other._length);
+        return *this;
+    }
+    String& operator=(String&& other) noexcept {
+        if (this != &other) {
+            free(_buffer);
+            _buffer = other._buffer;
+            _length = other._length;
+            _capacity = other._capacity;
+            other._buffer = nullptr;
+            other._length = 0;
+            other._capacity = 0;
+        }
+        return *this;
+    }
+    String& operator=(const char* cstr) {
+        if (cstr) assign(cstr, strlen(cstr)); else assign("", 0);
+        return *this;
+    }
+
+    bool reserve(unsigned int size) {
+        if (size <= _capacity && _buffer) return true;
+        char* grown = static_cast<char*>(realloc(_buffer, size + 1));
+        if (!grown) return false;
+        if (!_buffer) grown[0] = '\0';
+        _buffer = grown;
+        _capacity = size;
+        return true;
+    }
+
+    bool concat(const char* cstr, unsigned int length) {
+        if (!cstr) return false;
+        if (!reserve(_length + length)) return false;
+        memcpy(_buffer + _length, cstr, length);
+        _length += length;
+        _buffer[_length] = '\0';
+        return true;
+    }
+    bool concat(const char* cstr) { return cstr && concat(cstr, strlen(cstr)); }
+    bool concat(const String& other) { return concat(other.c_str(), other._length); }
+    bool concat(char c) { return concat(&c, 1); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) {
+        concat(value);
+        return *this;
+    }
+
+    const char* c_str() const { return _buffer ? _buffer : ""; }
+    unsigned int length() const { return _length; }
+    bool isEmpty() const { return _length == 0; }
+    char operator[](unsigned int index) const { return index < _length ? _buffer[index] : '\0'; }
+
+    bool equals(const char* cstr) const { return strcmp(c_str(), cstr ? cstr : "") == 0; }
+    bool operator==(const String& other) const { return _length == other._length && equals(other.c_str()); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !(*this == other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& other) const { return strcmp(c_str(), other.c_str()) < 0; }
+
+    int indexOf(const char* needle, unsigned int from = 0) const {
+        if (from >= _length && !(from == 0 && _length == 0)) return -1;
+        const char* found = strstr(c_str() + from, needle);
+        return found ? (int)(found - c_str()) : -1;
+    }
+    bool startsWith(const String& prefix) const { return strncmp(c_str(), prefix.c_str(), prefix._length) == 0; }
+    String substring(unsigned int from, unsigned int to) const {
+        to = std::min(to, _length);
+        String out;
+        if (from < to) out.concat(c_str() + from, to - from);
+        return out;
+    }
+    String substring(unsigned int from) const { return substring(from, _length); }
+
+    void replace(const String& find, const String& replacement) {
+        if (find._length == 0 || _length == 0) return;
+        String out;
+        const char* cursor = c_str();
+        const char* hit;
+        while ((hit = strstr(cursor, find.c_str())) != nullptr) {
+            out.concat(cursor, (unsigned int)(hit - cursor));
+            out.concat(replacement);
+            cursor = hit + find._length;
+        }
+        out.concat(cursor);
+        *this = std::move(out);
+    }
+
+    long toInt() const { return atol(c_str()); }
+
+private:
+    void assign(const char* cstr, unsigned int length) {
+        if (!reserve(length)) return;
+        memmove(_buffer, cstr, length);
+        _length = length;
+        _buffer[_length] = '\0';
+    }
+
+    template <typename... Args>
+    void assignFormatted(const char* format, Args... args) {
+        char buffer[64];
+        int written = snprintf(buffer, sizeof(buffer), format, args...);
+        assign(buffer, written < 0 ? 0 : std::min<unsigned int>(written, sizeof(buffer) - 1));
+    }
+
+    char* _buffer;
+    unsigned int _length;
+    unsigned int _capacity;
+};
+
+inline String operator+(const String& lhs, const String& rhs) { String out(lhs); out.concat(rhs); return out; }
+inline String operator+(const String& lhs, const char* rhs) { String out(lhs); out.concat(rhs); return out; }
+inline String operator+(const char* lhs, const String& rhs) { String out(lhs); out.concat(rhs); return out; }
+
+/**
+ * @brief Serial port that writes to stdout
+ */
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    size_t print(const char* text) { return fputs(text, stdout) < 0 ? 0 : strlen(text); }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(char c) { return fputc(c, stdout) < 0 ? 0 : 1; }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    size_t println() { return print('\n'); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+
+    __attribute__((format(printf, 2, 3)))
+    size_t printf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vfprintf(stdout, format, args);
+        va_end(args);
+        return written < 0 ? 0 : (size_t)written;
+    }
+
+    void flush() { fflush(stdout); }
+};
+
+inline HostSerial Serial;
+
+/**
+ * @brief Heap queries; the host has no PSRAM to report
+ */
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getPsramSize() { return 0; }
+    void restart() { exit(0); }
+};
+
+inline EspClass ESP;
+
+inline bool psramFound() { return false; }
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * @file Bounce2.h
+ * @brief Host stand-in for Bounce2; buttons never change state
+ */
+
+#include <stdint.h>
+
+namespace Bounce2 {
+
+class Button {
+public:
+    void attach(int pin, int mode) { (void)pin; (void)mode; }
+    void interval(uint16_t interval_ms) { (void)interval_ms; }
+    void setPressedState(bool state) { (void)state; }
+    bool update() { return false; }
+    bool read() const { return false; }
+    bool isPressed() const { return false; }
+    bool pressed() const { return false; }
+    bool released() const { return false; }
+};
+
+} // namespace Bounce2
@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file SystemController.h
+ * @brief Host stand-in for src/SystemController.h
+ *
+ * Found through -iquote ahead of the device header, which needs FreeRTOS.
+ * The state types match the device's; the state is set directly by the
+ * test, and state callbacks are only called once, on registration, as
+ * nothing changes the state behind them.
+ */
+
+#include <Arduino.h>
+#include <functional>
+#include "hardware/WiFiInterface.h"
+
+using WifiState = WiFiState;
+
+enum class ApiState {
+    API_NONE,
+    API_AWAITING_CONFIG,
+    API_CONFIG_INVALID,
+    API_CONFIGURED
+};
+
+enum class AuthState {
+    AUTH_NONE,
+    AUTH_AWAITING_LOGIN,
+    AUTH_CONFIRMED
+};
+
+enum class SystemState {
+    SYS_BOOTING,
+    SYS_READY,
+    SYS_IDLE,
+    SYS_INSIGHTS_CHANGED
+};
+
+struct ControllerState {
+    WifiState wifi_state;
+    ApiState api_state;
+    AuthState auth_state;
+    SystemState sys_state;
+    uint32_t version;
+};
+
+typedef std::function<void(const ControllerState&)> StateChangeCallback;
+
+class SystemController {
+public:
+    static WifiState getWifiState() { return state().wifi_state; }
+    static ApiState getApiState() { return state().api_state; }
+    static AuthState getAuthState() { return state().auth_state; }
+    static SystemState getSystemState() { return state().sys_state; }
+    static ControllerState getFullState() { return state(); }
+
+    static void onStateChange(StateChangeCallback callback) { callback(state()); }
+    static void removeAllCallbacks() {}
+
+    /**
+     * @brief State handed to cards; tests set it before building a card
+     */
+    static ControllerState& state() {
+        static ControllerState current = {WifiState::DISCONNECTED, ApiState::API_NONE,
+                                          AuthState::AUTH_NONE, SystemState::SYS_BOOTING, 0};
+        return current;
+    }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @file WiFiInterface.h
+ * @brief Host stand-in for src/hardware/WifiInterface.h
+ *
+ * Found through -iquote ahead of the device header, which needs the WiFi
+ * stack. Carries only what ProvisioningCard reads: the state enum and SSID.
+ */
+
+#include <Arduino.h>
+
+enum class WiFiState {
+    DISCONNECTED,
+    CONNECTING,
+    CONNECTED,
+    AP_MODE
+};
+
+class WiFiInterface {
+public:
+    explicit WiFiInterface(const char* ssid = "") : _ssid(ssid) {}
+
+    String getSSID() const { return _ssid; }
+    void setSSID(const String& ssid) { _ssid = ssid; }
+
+private:
+    String _ssid;
+};
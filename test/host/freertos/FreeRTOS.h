@@ -0,0 +1,256 @@
+#pragma once
+
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS kernel, for the native env
+ *
+ * Tasks are threads, ticks are milliseconds, and semaphores, queues and
+ * task notifications are built on a mutex and condition variable each.
+ * Covers only the calls the sources built by the native env make.
+ * Suspending the scheduler takes one process-wide lock, which gives the
+ * caller the same exclusivity a single core would.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define portYIELD_FROM_ISR(...)
+
+namespace host_rtos {
+
+/**
+ * @brief Wait on a condition for up to a number of ticks
+ * @return Whether the predicate held before the timeout
+ */
+template <typename Predicate>
+bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Predicate ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+/**
+ * @brief Counting semaphore; a mutex starts with one token, a binary semaphore with none
+ */
+struct Semaphore {
+    Semaphore(UBaseType_t initial, UBaseType_t max) : count(initial), max_count(max) {}
+    std::mutex mutex;
+    std::condition_variable available;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+/**
+ * @brief Queue of fixed-size items
+ */
+struct Queue {
+    Queue(UBaseType_t length, UBaseType_t size) : capacity(length), item_size(size) {}
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t capacity;
+    UBaseType_t item_size;
+};
+
+/**
+ * @brief A task: its thread and notification count
+ */
+struct Task {
+    const char* name = "main";
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+};
+
+inline Task*& currentTask() {
+    static Task main_task;
+    thread_local Task* current = &main_task;
+    return current;
+}
+
+inline std::recursive_mutex& schedulerLock() {
+    static std::recursive_mutex lock;
+    return lock;
+}
+
+} // namespace host_rtos
+
+typedef host_rtos::Semaphore* SemaphoreHandle_t;
+typedef host_rtos::Queue* QueueHandle_t;
+typedef host_rtos::Task* TaskHandle_t;
+
+// Semaphores
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new host_rtos::Semaphore(1, 1); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new host_rtos::Semaphore(0, 1); }
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!host_rtos::waitFor(semaphore->available, lock, ticks, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->count >= semaphore->max_count) {
+            return pdFALSE;
+        }
+        semaphore->count++;
+    }
+    semaphore->available.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(semaphore);
+}
+
+// Queues
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return new host_rtos::Queue(length, item_size);
+}
+
+inline void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!host_rtos::waitFor(queue->changed, lock, ticks, [queue] { return queue->items.size() < queue->capacity; })) {
+            return pdFAIL;
+        }
+        const uint8_t* bytes = static_cast<const uint8_t*>(item);
+        queue->items.emplace_back(bytes, bytes + queue->item_size);
+    }
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    return xQueueSend(queue, item, ticks);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!host_rtos::waitFor(queue->changed, lock, ticks, [queue] { return !queue->items.empty(); })) {
+            return pdFAIL;
+        }
+        memcpy(item, queue->items.front().data(), queue->item_size);
+        queue->items.pop_front();
+    }
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+
+// Tasks
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth,
+                              void* parameter, UBaseType_t priority, TaskHandle_t* created) {
+    (void)stack_depth;
+    (void)priority;
+    host_rtos::Task* task = new host_rtos::Task();
+    task->name = name;
+    if (created) *created = task;
+    task->thread = std::thread([task, function, parameter] {
+        host_rtos::currentTask() = task;
+        function(parameter);
+    });
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth,
+                                          void* parameter, UBaseType_t priority, TaskHandle_t* created,
+                                          BaseType_t core) {
+    (void)core;
+    return xTaskCreate(function, name, stack_depth, parameter, priority, created);
+}
+
+/**
+ * @brief Delete a task
+ *
+ * A task deleting itself just returns; its function must return next.
+ * Deleting another task waits for its function to return, so that task
+ * must already be on its way out.
+ */
+inline void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == host_rtos::currentTask()) {
+        return;
+    }
+    if (task->thread.joinable()) {
+        task->thread.join();
+    }
+    delete task;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return host_rtos::currentTask(); }
+
+inline const char* pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : host_rtos::currentTask())->name;
+}
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+inline void xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->notified.notify_one();
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    xTaskNotifyGive(task);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    host_rtos::Task* task = host_rtos::currentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    host_rtos::waitFor(task->notified, lock, ticks, [task] { return task->notifications > 0; });
+    uint32_t count = task->notifications;
+    if (count > 0) {
+        task->notifications = clear_on_exit ? 0 : count - 1;
+    }
+    return count;
+}
+
+inline void vTaskSuspendAll() { host_rtos::schedulerLock().lock(); }
+inline BaseType_t xTaskResumeAll() { host_rtos::schedulerLock().unlock(); return pdFALSE; }
+
+inline BaseType_t xPortGetCoreID() { return 0; }
@@ -0,0 +1,4 @@
+#pragma once
+
+// Everything lives in the FreeRTOS.h stand-in
+#include "FreeRTOS.h"
@@ -0,0 +1,159 @@
+/**
+ * @file test_event_queue.cpp
+ * @brief Benchmarks EventQueue dispatch against the number of cards
+ *
+ * Every insight card listens for events about its own insight. With topic
+ * subscriptions an event runs only the handlers for its (type, insightId).
+ * The broadcast path it replaced subscribed every card to every event and
+ * left each handler to drop events for other insights. This times both
+ * with 1, 10, 20 and 50 cards, using the real event task (a thread, on the
+ * FreeRTOS stand-in). The event task's CPU time is the dispatch cost; wall
+ * time also includes waking the task for each event.
+ *
+ * Run with: pio test -e native -f test_event_queue
+ */
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include "EventQueue.h"
+
+namespace {
+
+const size_t CARD_COUNTS[] = {1, 10, 20, 50};
+const uint32_t EVENTS = 2000;
+const size_t POOL_SIZE = 32;
+const uint32_t TIMEOUT_MS = 10000;
+
+// Not coalescable, so every published event is dispatched
+const EventType EVENT_TYPE = EventType::INSIGHT_DATA_ERROR;
+
+enum class Subscription {
+    TOPIC,       ///< One (type, insightId) subscription per card
+    BROADCAST    ///< One catch-all subscription per card, filtering in the handler
+};
+
+double threadCpuUs() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+struct Counters {
+    std::atomic<uint32_t> calls{0};       ///< Handlers run
+    std::atomic<uint32_t> delivered{0};   ///< Handlers that kept the event
+    double first_cpu_us = 0;              ///< Event task CPU time at the first delivery
+    double last_cpu_us = 0;               ///< Event task CPU time at the last delivery
+
+    void deliver() {
+        uint32_t count = ++delivered;
+        if (count == 1) {
+            first_cpu_us = threadCpuUs();
+        } else if (count == EVENTS) {
+            last_cpu_us = threadCpuUs();
+        }
+    }
+};
+
+struct DispatchResult {
+    uint32_t calls;
+    uint32_t delivered;
+    double us_per_event;   ///< Wall time, including waking the event task
+    double cpu_per_event;  ///< Event task CPU time: receive, look up and run handlers
+};
+
+/**
+ * @brief Publish EVENTS events round-robin over the cards' insights and time their dispatch
+ */
+DispatchResult dispatchEvents(size_t cards, Subscription mode) {
+    Counters counters;
+    std::vector<String> ids;
+    for (size_t i = 0; i < cards; i++) {
+        ids.push_back(String("insight-") + String((unsigned)i));
+    }
+
+    EventQueue queue(POOL_SIZE);
+    std::vector<EventSubscription> subscriptions;
+    for (const String& id : ids) {
+        if (mode == Subscription::TOPIC) {
+            subscriptions.push_back(queue.subscribe(EVENT_TYPE, id, [&counters](const Event& event) {
+                counters.calls++;
+                counters.deliver();
+            }));
+        } else {
+            const String* card_id = &id;
+            subscriptions.push_back(queue.subscribe([&counters, card_id](const Event& event) {
+                counters.calls++;
+                if (event.type != EVENT_TYPE || event.insightId != *card_id) {
+                    return;
+                }
+                counters.deliver();
+            }));
+        }
+    }
+    queue.begin();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < EVENTS; i++) {
+        // Only this thread publishes, so once a slot is free the publish can't fail
+        while (queue.getStats().inUse >= POOL_SIZE) {
+            std::this_thread::yield();
+        }
+        queue.publishEvent(EVENT_TYPE, ids[i % cards]);
+    }
+    auto deadline = start + std::chrono::milliseconds(TIMEOUT_MS);
+    while (counters.delivered.load() < EVENTS && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    subscriptions.clear();
+    queue.end();
+
+    DispatchResult result;
+    result.calls = counters.calls.load();
+    result.delivered = counters.delivered.load();
+    result.us_per_event = std::chrono::duration<double, std::micro>(elapsed).count() / EVENTS;
+    result.cpu_per_event = (counters.last_cpu_us - counters.first_cpu_us) / (EVENTS - 1);
+    return result;
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_dispatch_cost_by_card_count() {
+    for (size_t cards : CARD_COUNTS) {
+        DispatchResult topic = dispatchEvents(cards, Subscription::TOPIC);
+        DispatchResult broadcast = dispatchEvents(cards, Subscription::BROADCAST);
+
+        char line[200];
+        snprintf(line, sizeof(line),
+                 "%2u cards: topic %.2f us/event CPU (%.1f wall, %u calls), "
+                 "broadcast %.2f us/event CPU (%.1f wall, %u calls)",
+                 (unsigned)cards, topic.cpu_per_event, topic.us_per_event, topic.calls,
+                 broadcast.cpu_per_event, broadcast.us_per_event, broadcast.calls);
+        TEST_MESSAGE(line);
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENTS, topic.delivered, "Topic dispatch lost events");
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENTS, broadcast.delivered, "Broadcast dispatch lost events");
+        // Topic dispatch runs only the card the event is for; broadcast runs every card
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENTS, topic.calls, "Topic dispatch ran other cards' handlers");
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(EVENTS * cards, broadcast.calls, "Broadcast should run every handler");
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_dispatch_cost_by_card_count);
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_lan_hub.cpp
+ * @brief Round-trips LanHub packets through the codec and the reassembler
+ *
+ * Every chunk is encoded with LanHubProtocol::encodeHeader, decoded again
+ * the way a follower receives it, then fed to a SnapshotReassembler.
+ *
+ * Run with: pio test -e native -f test_lan_hub
+ */
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "posthog/LanHubProtocol.h"
+
+namespace {
+
+using PacketType = LanHubProtocol::PacketType;
+using PacketHeader = LanHubProtocol::PacketHeader;
+
+const char* INSIGHT_ID = "aB3dE5fG";
+const uint32_t SEQ = 0xA1B2C3D4;
+const size_t CHUNK_SIZE = 10;
+
+/**
+ * @brief Encode one chunk of a snapshot as a datagram
+ */
+std::vector<uint8_t> encodeChunk(const String& insightId, uint32_t seq, uint8_t index, uint8_t count,
+                                 const std::string& payload) {
+    std::vector<uint8_t> packet(LanHubProtocol::HEADER_SIZE + LanHubProtocol::MAX_INSIGHT_ID_LENGTH + payload.size());
+    size_t headerLength = LanHubProtocol::encodeHeader(packet.data(), packet.size(), PacketType::SNAPSHOT, 0,
+                                                       seq, index, count, insightId);
+    TEST_ASSERT_NOT_EQUAL(0, headerLength);
+    memcpy(packet.data() + headerLength, payload.data(), payload.size());
+    packet.resize(headerLength + payload.size());
+    return packet;
+}
+
+/**
+ * @brief Split a snapshot into CHUNK_SIZE datagrams
+ */
+std::vector<std::vector<uint8_t>> encodeSnapshot(const std::string& json, uint32_t seq) {
+    uint8_t count = (uint8_t)((json.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    std::vector<std::vector<uint8_t>> packets;
+    for (uint8_t i = 0; i < count; i++) {
+        packets.push_back(encodeChunk(INSIGHT_ID, seq, i, count, json.substr(i * CHUNK_SIZE, CHUNK_SIZE)));
+    }
+    return packets;
+}
+
+/**
+ * @brief Decode a datagram and hand it to the reassembler, as LanHub::process() does
+ */
+bool receive(SnapshotReassembler& reassembler, const std::vector<uint8_t>& packet, unsigned long now,
+             String& completed) {
+    PacketHeader header;
+    size_t offset = LanHubProtocol::decodeHeader(packet.data(), packet.size(), header);
+    TEST_ASSERT_NOT_EQUAL(0, offset);
+    return reassembler.addChunk(header, packet.data() + offset, packet.size() - offset, now, completed);
+}
+
+const std::string SNAPSHOT = "{\"result\":[{\"data\":[1,2,3,4,5],\"label\":\"Pageviews\"}]}";
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_header_round_trip() {
+    uint8_t packet[LanHubProtocol::HEADER_SIZE + LanHubProtocol::MAX_INSIGHT_ID_LENGTH];
+    size_t written = LanHubProtocol::encodeHeader(packet, sizeof(packet), PacketType::REQUEST,
+                                                  LanHubProtocol::FLAG_FORCE_REFRESH, SEQ, 3, 7, INSIGHT_ID);
+    TEST_ASSERT_EQUAL(LanHubProtocol::HEADER_SIZE + strlen(INSIGHT_ID), written);
+
+    PacketHeader header;
+    TEST_ASSERT_EQUAL(written, LanHubProtocol::decodeHeader(packet, written, header));
+    TEST_ASSERT_TRUE(header.type == PacketType::REQUEST);
+    TEST_ASSERT_EQUAL_UINT8(LanHubProtocol::FLAG_FORCE_REFRESH, header.flags);
+    TEST_ASSERT_EQUAL_UINT32(SEQ, header.seq);
+    TEST_ASSERT_EQUAL_UINT8(3, header.chunkIndex);
+    TEST_ASSERT_EQUAL_UINT8(7, header.chunkCount);
+    TEST_ASSERT_EQUAL_STRING(INSIGHT_ID, header.insightId.c_str());
+}
+
+void test_bad_magic_is_rejected() {
+    std::vector<uint8_t> packet = encodeChunk(INSIGHT_ID, SEQ, 0, 1, "{}");
+    PacketHeader header;
+    TEST_ASSERT_NOT_EQUAL(0, LanHubProtocol::decodeHeader(packet.data(), packet.size(), header));
+
+    packet[0] = 'X';
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet.data(), packet.size(), header));
+
+    packet[0] = 'P';
+    packet[4] = LanHubProtocol::PROTOCOL_VERSION + 1;
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet.data(), packet.size(), header));
+}
+
+void test_over_length_id_is_rejected() {
+    String longId;
+    for (size_t i = 0; i <= LanHubProtocol::MAX_INSIGHT_ID_LENGTH; i++) {
+        longId += 'x';
+    }
+    uint8_t packet[LanHubProtocol::HEADER_SIZE + 2 * LanHubProtocol::MAX_INSIGHT_ID_LENGTH];
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::encodeHeader(packet, sizeof(packet), PacketType::SNAPSHOT, 0,
+                                                      SEQ, 0, 1, longId));
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::encodeHeader(packet, sizeof(packet), PacketType::SNAPSHOT, 0,
+                                                      SEQ, 0, 1, String("")));
+
+    // A foreign sender claiming a longer ID, with the bytes to back it
+    size_t written = LanHubProtocol::encodeHeader(packet, sizeof(packet), PacketType::SNAPSHOT, 0,
+                                                  SEQ, 0, 1, INSIGHT_ID);
+    packet[7] = (uint8_t)(LanHubProtocol::MAX_INSIGHT_ID_LENGTH + 1);
+    PacketHeader header;
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet, sizeof(packet), header));
+
+    // An ID length running past the end of the datagram
+    packet[7] = (uint8_t)(strlen(INSIGHT_ID) + 1);
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet, written, header));
+}
+
+void test_bad_chunk_numbering_is_rejected() {
+    std::vector<uint8_t> packet = encodeChunk(INSIGHT_ID, SEQ, 0, 1, "{}");
+    PacketHeader header;
+
+    packet[12] = 1; // index == count
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet.data(), packet.size(), header));
+
+    packet[12] = 0;
+    packet[13] = LanHubProtocol::MAX_CHUNKS + 1;
+    TEST_ASSERT_EQUAL(0, LanHubProtocol::decodeHeader(packet.data(), packet.size(), header));
+}
+
+void test_out_of_order_chunks_reassemble() {
+    std::vector<std::vector<uint8_t>> packets = encodeSnapshot(SNAPSHOT, SEQ);
+    TEST_ASSERT_EQUAL(6, packets.size());
+
+    SnapshotReassembler reassembler;
+    String completed;
+    const size_t order[] = {4, 1, 5, 0, 3};
+    for (size_t index : order) {
+        TEST_ASSERT_FALSE(receive(reassembler, packets[index], 0, completed));
+        // A duplicate doesn't count towards completion
+        TEST_ASSERT_FALSE(receive(reassembler, packets[index], 0, completed));
+    }
+    TEST_ASSERT_TRUE(receive(reassembler, packets[2], 0, completed));
+
+    TEST_ASSERT_EQUAL_STRING(SNAPSHOT.c_str(), completed.c_str());
+    TEST_ASSERT_EQUAL(0, reassembler.pending());
+}
+
+void test_lost_chunk_times_out() {
+    std::vector<std::vector<uint8_t>> packets = encodeSnapshot(SNAPSHOT, SEQ);
+    SnapshotReassembler reassembler;
+    String completed;
+    const unsigned long start = 1000;
+
+    // Chunk 1 never arrives
+    for (size_t index = 0; index < packets.size(); index++) {
+        if (index != 1) {
+            TEST_ASSERT_FALSE(receive(reassembler, packets[index], start, completed));
+        }
+    }
+    TEST_ASSERT_EQUAL(1, reassembler.pending());
+
+    reassembler.prune(start + SnapshotReassembler::TIMEOUT - 1);
+    TEST_ASSERT_EQUAL(1, reassembler.pending());
+    reassembler.prune(start + SnapshotReassembler::TIMEOUT);
+    TEST_ASSERT_EQUAL(0, reassembler.pending());
+
+    // The straggler alone can't complete a snapshot whose other chunks were dropped
+    TEST_ASSERT_FALSE(receive(reassembler, packets[1], start + SnapshotReassembler::TIMEOUT, completed));
+    TEST_ASSERT_TRUE(completed.isEmpty());
+}
+
+void test_newer_sequence_abandons_partial_snapshot() {
+    std::vector<std::vector<uint8_t>> stale = encodeSnapshot(SNAPSHOT, SEQ);
+    std::vector<std::vector<uint8_t>> fresh = encodeSnapshot(SNAPSHOT, SEQ + 1);
+    SnapshotReassembler reassembler;
+    String completed;
+
+    TEST_ASSERT_FALSE(receive(reassembler, stale[0], 0, completed));
+    for (size_t index = 1; index < fresh.size(); index++) {
+        TEST_ASSERT_FALSE(receive(reassembler, fresh[index], 0, completed));
+    }
+    // The stale chunk 0 was discarded; only the fresh one completes the snapshot
+    TEST_ASSERT_TRUE(receive(reassembler, fresh[0], 0, completed));
+    TEST_ASSERT_EQUAL_STRING(SNAPSHOT.c_str(), completed.c_str());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_bad_magic_is_rejected);
+    RUN_TEST(test_over_length_id_is_rejected);
+    RUN_TEST(test_bad_chunk_numbering_is_rejected);
+    RUN_TEST(test_out_of_order_chunks_reassemble);
+    RUN_TEST(test_lost_chunk_times_out);
+    RUN_TEST(test_newer_sequence_abandons_partial_snapshot);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+/**
+ * @file test_refresh_schedule.cpp
+ * @brief Simulates a fleet's refresh schedule to check requests stay spread out
+ *
+ * Devices from one order have consecutive MACs and are usually powered on
+ * together. Without a per-device phase, every one of them would refresh in
+ * the same second. This runs RefreshSchedule for such a fleet and checks the
+ * busiest second of the resulting request histogram.
+ *
+ * Run with: pio test -e native -f test_refresh_schedule
+ */
+
+#include <unity.h>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "posthog/RefreshSchedule.h"
+
+namespace {
+
+const unsigned long INTERVAL = 30000;      ///< Matches PostHogClient::REFRESH_INTERVAL
+const unsigned long JITTER = 3000;         ///< Matches PostHogClient::REFRESH_JITTER
+const uint64_t FIRST_MAC = 0x24A1603B5C00ull;
+const size_t DEVICES = 50;
+const unsigned long INTERVALS = 10;
+const unsigned long SECONDS = INTERVALS * INTERVAL / 1000 + 2 * INTERVAL / 1000;
+
+/**
+ * An even spread is 50 devices over 30 seconds, under 2 a second; in
+ * lockstep all 50 land in one second. Random jitter clusters a few, so
+ * allow a handful more than even.
+ */
+const unsigned MAX_PER_SECOND = 8;
+
+std::mt19937 rng(12345);
+
+long seededRandom(long howbig) {
+    return std::uniform_int_distribution<long>(0, howbig - 1)(rng);
+}
+
+/**
+ * @brief Count refreshes per second for DEVICES devices booted together
+ */
+std::vector<unsigned> refreshesPerSecond() {
+    std::vector<unsigned> histogram(SECONDS, 0);
+    for (size_t device = 0; device < DEVICES; device++) {
+        uint64_t mac = FIRST_MAC + device;
+        RefreshSchedule::Slot next;
+        next.slot = RefreshSchedule::phaseOffset(mac, INTERVAL);
+        next.due = next.slot;
+        for (unsigned long i = 0; i < INTERVALS; i++) {
+            histogram[next.due / 1000]++;
+            // PostHogClient reschedules as soon as the refresh fires
+            next = RefreshSchedule::next(next.slot, next.due, INTERVAL, JITTER, seededRandom);
+        }
+    }
+    return histogram;
+}
+
+} // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_phase_offset_is_within_interval() {
+    for (size_t device = 0; device < DEVICES; device++) {
+        TEST_ASSERT_LESS_THAN_UINT32(INTERVAL, RefreshSchedule::phaseOffset(FIRST_MAC + device, INTERVAL));
+    }
+}
+
+void test_next_skips_missed_slots_and_jitters_within_bound() {
+    // Busy for two and a half intervals: the missed slots are skipped, not fired in a burst
+    RefreshSchedule::Slot next = RefreshSchedule::next(1000, 1000 + 2 * INTERVAL + INTERVAL / 2,
+                                                       INTERVAL, JITTER, seededRandom);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 3 * INTERVAL, next.slot);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(next.slot, next.due);
+    TEST_ASSERT_LESS_THAN_UINT32(next.slot + JITTER, next.due);
+}
+
+void test_fleet_requests_per_second_stay_bounded() {
+    std::vector<unsigned> histogram = refreshesPerSecond();
+
+    unsigned total = 0;
+    unsigned busiest = 0;
+    size_t busiest_second = 0;
+    for (size_t second = 0; second < histogram.size(); second++) {
+        total += histogram[second];
+        if (histogram[second] > busiest) {
+            busiest = histogram[second];
+            busiest_second = second;
+        }
+    }
+
+    char line[120];
+    snprintf(line, sizeof(line), "%u devices, %lu intervals: busiest second %u has %u refreshes",
+             (unsigned)DEVICES, INTERVALS, (unsigned)busiest_second, busiest);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(DEVICES * INTERVALS, total);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(MAX_PER_SECOND, busiest);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_phase_offset_is_within_interval);
+    RUN_TEST(test_next_skips_missed_slots_and_jitters_within_bound);
+    RUN_TEST(test_fleet_requests_per_second_stay_bounded);
+    return UNITY_END();
+}
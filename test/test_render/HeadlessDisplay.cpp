@@ -0,0 +1,144 @@
+#include "HeadlessDisplay.h"
+#include <string.h>
+
+HeadlessDisplay* HeadlessDisplay::_instance = nullptr;
+uint32_t HeadlessDisplay::_now_ms = 0;
+
+static uint32_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+HeadlessDisplay::HeadlessDisplay(DisplayPanel* panel)
+    : _display(nullptr),
+      _panel(panel),
+      _render_buffer((size_t)WIDTH * BUFFER_ROWS * BYTES_PER_PIXEL),
+      _second_buffer(panel ? _render_buffer.size() : 0),
+      _framebuffer((size_t)WIDTH * HEIGHT * BYTES_PER_PIXEL, 0),
+      _stats{} {
+    _instance = this;
+    lv_tick_set_cb(_tick_ms);
+
+    _display = lv_display_create(WIDTH, HEIGHT);
+    lv_display_set_default(_display);
+    lv_display_set_color_format(_display, COLOR_FORMAT);
+    lv_display_set_flush_cb(_display, _flush);
+    if (_panel) {
+        // Flushes complete from the panel, as in DisplayInterface::begin()
+        lv_display_set_flush_wait_cb(_display, _flush_wait);
+        _panel->setFlushDoneCallback(_flush_done, _display);
+    }
+    lv_display_add_event_cb(_display, _render_event, LV_EVENT_INVALIDATE_AREA, nullptr);
+    lv_display_add_event_cb(_display, _render_event, LV_EVENT_RENDER_START, nullptr);
+    lv_display_add_event_cb(_display, _render_event, LV_EVENT_RENDER_READY, nullptr);
+    lv_display_set_buffers(
+        _display,
+        _render_buffer.data(),
+        _panel ? _second_buffer.data() : nullptr,
+        _render_buffer.size(),
+        LV_DISPLAY_RENDER_MODE_PARTIAL
+    );
+
+    // Same screen style as DisplayInterface::begin()
+    lv_obj_set_style_bg_color(screen(), lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(screen(), LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(screen(), 0, 0);
+}
+
+HeadlessDisplay::~HeadlessDisplay() {
+    if (_panel) {
+        _panel->waitForFlush();
+        _panel->setFlushDoneCallback(nullptr, nullptr);
+    }
+    lv_display_delete(_display);
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+lv_obj_t* HeadlessDisplay::screen() const {
+    return lv_display_get_screen_active(_display);
+}
+
+void HeadlessDisplay::run(uint32_t ms) {
+    uint32_t elapsed = 0;
+    do {
+        _now_ms += LV_DEF_REFR_PERIOD;
+        elapsed += LV_DEF_REFR_PERIOD;
+        lv_timer_handler();
+    } while (elapsed < ms);
+}
+
+FrameStats HeadlessDisplay::takeStats() {
+    FrameStats stats = _stats;
+    _stats = FrameStats{};
+    return stats;
+}
+
+const std::vector<uint8_t>& HeadlessDisplay::framebuffer() const {
+    return _framebuffer;
+}
+
+uint32_t HeadlessDisplay::_tick_ms() {
+    return _now_ms;
+}
+
+void HeadlessDisplay::_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
+    if (_instance) {
+        auto start = std::chrono::steady_clock::now();
+        size_t row_bytes = (size_t)lv_area_get_width(area) * BYTES_PER_PIXEL;
+        const uint8_t* src = px_map;
+        for (int32_t y = area->y1; y <= area->y2; ++y) {
+            memcpy(&_instance->_framebuffer[((size_t)y * WIDTH + area->x1) * BYTES_PER_PIXEL], src, row_bytes);
+            src += row_bytes;
+        }
+        _instance->_stats.flush_us += elapsedUs(start);
+        _instance->_stats.flushed_px += lv_area_get_size(area);
+
+        // On success the panel reports completion once the window is sent
+        DisplayPanel* panel = _instance->_panel;
+        if (panel && panel->drawPixels(area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area),
+                                       reinterpret_cast<const uint16_t*>(px_map))) {
+            return;
+        }
+    }
+    lv_display_flush_ready(disp);
+}
+
+void HeadlessDisplay::_flush_wait(lv_display_t* disp) {
+    (void)disp;
+    if (_instance && _instance->_panel) {
+        _instance->_panel->waitForFlush();
+    }
+}
+
+void HeadlessDisplay::_flush_done(void* context) {
+    lv_display_flush_ready(static_cast<lv_display_t*>(context));
+}
+
+void HeadlessDisplay::_render_event(lv_event_t* e) {
+    if (!_instance) {
+        return;
+    }
+
+    FrameStats& stats = _instance->_stats;
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA:
+            stats.invalidated_px += lv_area_get_size(static_cast<const lv_area_t*>(lv_event_get_param(e)));
+            break;
+        case LV_EVENT_RENDER_START:
+            _instance->_render_start = std::chrono::steady_clock::now();
+            break;
+        case LV_EVENT_RENDER_READY: {
+            uint32_t us = elapsedUs(_instance->_render_start);
+            stats.frames++;
+            stats.render_us += us;
+            if (us > stats.max_render_us) {
+                stats.max_render_us = us;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <lvgl.h>
+#include <chrono>
+#include <vector>
+#include "hardware/DisplayPanel.h"
+
+/**
+ * @brief Render cost of the frames drawn since stats were last taken
+ */
+struct FrameStats {
+    uint32_t frames;          ///< Renders that ran
+    uint32_t render_us;       ///< Time from render start to ready, flushes included
+    uint32_t max_render_us;   ///< Slowest single render
+    uint32_t flush_us;        ///< Time spent in the flush callback
+    uint32_t invalidated_px;  ///< Area invalidated, before LVGL joins overlapping areas
+    uint32_t flushed_px;      ///< Area actually redrawn and flushed
+};
+
+/**
+ * @brief In-memory LVGL display the size and format of the device's panel
+ *
+ * Renders in the device's format, RGB565 high byte first, in bands the
+ * height of the device's render buffers, and flushes them into a full-screen
+ * framebuffer. The framebuffer holds exactly the bytes the panel would be
+ * sent, and the same objects take the same number of passes they do there.
+ * LVGL's clock is simulated and only moves in run(), which makes animation
+ * frames repeatable.
+ *
+ * Given a DisplayPanel, it also renders into two buffers and flushes
+ * through the panel the way DisplayInterface does: the flush queues the
+ * window, the panel's completion callback marks it flushed, and LVGL waits
+ * on the panel before reusing a buffer.
+ *
+ * One instance at a time; lv_init() must have been called.
+ */
+class HeadlessDisplay {
+public:
+    static constexpr uint16_t WIDTH = 240;
+    static constexpr uint16_t HEIGHT = 135;
+    static constexpr uint16_t BUFFER_ROWS = 27;   ///< Same band as main.cpp's LVGL_BUFFER_ROWS
+    static constexpr lv_color_format_t COLOR_FORMAT = LV_COLOR_FORMAT_RGB565_SWAPPED;  ///< As DisplayInterface::begin()
+    static constexpr uint32_t BYTES_PER_PIXEL = 2;
+
+    /**
+     * @param panel Panel to flush through as well, or null to complete flushes at once
+     */
+    explicit HeadlessDisplay(DisplayPanel* panel = nullptr);
+    ~HeadlessDisplay();
+
+    /**
+     * @brief Get the active screen, black like the device's
+     */
+    lv_obj_t* screen() const;
+
+    /**
+     * @brief Advance LVGL's clock, running its timers every refresh period
+     *
+     * @param ms Simulated milliseconds to run for
+     */
+    void run(uint32_t ms);
+
+    /**
+     * @brief Get and reset the stats of the frames rendered so far
+     */
+    FrameStats takeStats();
+
+    /**
+     * @brief Get the framebuffer, WIDTH x HEIGHT RGB565 pixels, high byte first
+     */
+    const std::vector<uint8_t>& framebuffer() const;
+
+private:
+    lv_display_t* _display;
+    DisplayPanel* _panel;
+    std::vector<uint8_t> _render_buffer;
+    std::vector<uint8_t> _second_buffer;   ///< Only with a panel
+    std::vector<uint8_t> _framebuffer;
+    FrameStats _stats;
+    std::chrono::steady_clock::time_point _render_start;
+
+    static HeadlessDisplay* _instance;
+    static uint32_t _now_ms;
+
+    static uint32_t _tick_ms();
+    static void _flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
+    static void _flush_wait(lv_display_t* disp);
+    static void _flush_done(void* context);
+    static void _render_event(lv_event_t* e);
+
+    HeadlessDisplay(const HeadlessDisplay&) = delete;
+    HeadlessDisplay& operator=(const HeadlessDisplay&) = delete;
+};
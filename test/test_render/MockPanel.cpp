@@ -0,0 +1,91 @@
+#include "MockPanel.h"
+
+MockPanel::MockPanel(uint32_t pixel_clock_hz)
+    : _pixel_clock_hz(pixel_clock_hz),
+      _start(Clock::now()),
+      _stopping(false),
+      _timer(&MockPanel::run, this) {
+}
+
+MockPanel::~MockPanel() {
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _changed.notify_all();
+    _timer.join();
+}
+
+bool MockPanel::begin() {
+    return true;
+}
+
+bool MockPanel::drawPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _windows.push_back({x, y, w, h, pixels, elapsedUs(), 0, false});
+        _in_flight.push_back(_windows.size() - 1);
+    }
+    _changed.notify_all();
+    return true;
+}
+
+void MockPanel::waitForFlush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    // LVGL only waits once it has rendered the next band into its other buffer
+    if (!_in_flight.empty()) {
+        _windows[_in_flight.front()].rendered_next_in_flight = true;
+    }
+    _changed.wait(lock, [this] { return _in_flight.empty(); });
+}
+
+void MockPanel::waitIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this] { return _in_flight.empty(); });
+}
+
+std::vector<MockPanel::Window> MockPanel::windows() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _windows;
+}
+
+void MockPanel::clear() {
+    waitIdle();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _windows.clear();
+}
+
+void MockPanel::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Clock::time_point bus_free = Clock::now();
+    while (true) {
+        _changed.wait(lock, [this] { return _stopping || !_in_flight.empty(); });
+        if (_in_flight.empty()) {
+            return;
+        }
+
+        // Windows go out back to back, each once the previous one has been sent
+        const Window& window = _windows[_in_flight.front()];
+        uint64_t bits = (uint64_t)window.w * window.h * 16;
+        Clock::time_point queued = _start + std::chrono::microseconds(window.queued_us);
+        Clock::time_point done = std::max(queued, bus_free) +
+                                 std::chrono::microseconds(bits * 1000000 / _pixel_clock_hz);
+        lock.unlock();
+        std::this_thread::sleep_until(done);
+        bus_free = done;
+
+        // Report before the window stops counting as in flight, so a
+        // waitForFlush() that returns has seen the completion
+        notifyFlushDone();
+
+        lock.lock();
+        _windows[_in_flight.front()].done_us = elapsedUs();
+        _in_flight.pop_front();
+        _changed.notify_all();
+    }
+}
+
+uint32_t MockPanel::elapsedUs() const {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - _start).count();
+}
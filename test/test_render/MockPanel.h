@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "hardware/DisplayPanel.h"
+
+/**
+ * @class MockPanel
+ * @brief DisplayPanel that records windows and takes as long as SPI would
+ *
+ * drawPixels() queues a window and returns at once, like ST7789Panel's DMA
+ * queue. A timer thread finishes windows one after another, each taking the
+ * time its bytes need at the pixel clock, and reports them through
+ * notifyFlushDone() as the SPI interrupt would.
+ */
+class MockPanel : public DisplayPanel {
+public:
+    /**
+     * @brief One window handed to drawPixels()
+     */
+    struct Window {
+        int16_t x;
+        int16_t y;
+        uint16_t w;
+        uint16_t h;
+        const uint16_t* pixels;       ///< Buffer LVGL rendered into
+        uint32_t queued_us;           ///< When drawPixels() was called
+        uint32_t done_us;             ///< When the transfer finished, 0 while in flight
+        bool rendered_next_in_flight; ///< LVGL had the next band ready while this one was in flight
+    };
+
+    /**
+     * @param pixel_clock_hz Simulated SPI clock, 16 bits per pixel
+     */
+    explicit MockPanel(uint32_t pixel_clock_hz);
+    ~MockPanel() override;
+
+    bool begin() override;
+    bool drawPixels(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) override;
+    void waitForFlush() override;
+
+    /**
+     * @brief Get the windows queued so far, oldest first
+     */
+    std::vector<Window> windows() const;
+
+    /**
+     * @brief Forget the windows recorded so far (waits for them first)
+     */
+    void clear();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Timer thread: finish queued windows in order
+     */
+    void run();
+
+    /**
+     * @brief Block until every window is sent, without counting it as LVGL waiting
+     */
+    void waitIdle();
+
+    uint32_t elapsedUs() const;
+
+    uint32_t _pixel_clock_hz;
+    Clock::time_point _start;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+    std::vector<Window> _windows;   ///< Every window, guarded by _mutex
+    std::deque<size_t> _in_flight;  ///< Indices into _windows not yet sent
+    bool _stopping;
+    std::thread _timer;
+};
@@ -0,0 +1,229 @@
+#include "Png.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+const size_t MAX_STORED_BLOCK = 65535;
+
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool table_ready = false;
+    if (!table_ready) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        table_ready = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t length) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < length; ++i) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+void putChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    putU32(out, data.size());
+    size_t crc_start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putU32(out, crc32(&out[crc_start], out.size() - crc_start));
+}
+
+// Widen a channel by repeating its top bits, so narrowing it again is exact
+uint8_t widen(uint32_t value, int bits) {
+    return (uint8_t)((value << (8 - bits)) | (value >> (2 * bits - 8)));
+}
+
+} // namespace
+
+bool Png::write(const std::string& path, const std::vector<uint8_t>& pixels,
+                uint16_t width, uint16_t height) {
+    if (pixels.size() != (size_t)width * height * 2) {
+        printf("[Png] %s: %zu bytes for a %ux%u image\n", path.c_str(), pixels.size(), width, height);
+        return false;
+    }
+
+    // Each row is a filter byte (none) and the RGB triplets
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)height * (1 + width * 3));
+    for (uint16_t y = 0; y < height; ++y) {
+        raw.push_back(0);
+        for (uint16_t x = 0; x < width; ++x) {
+            size_t i = ((size_t)y * width + x) * 2;
+            uint16_t px = (pixels[i] << 8) | pixels[i + 1];
+            raw.push_back(widen(px >> 11, 5));
+            raw.push_back(widen((px >> 5) & 0x3F, 6));
+            raw.push_back(widen(px & 0x1F, 5));
+        }
+    }
+
+    // zlib stream of stored blocks
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    size_t offset = 0;
+    bool last = false;
+    while (!last) {
+        size_t length = raw.size() - offset < MAX_STORED_BLOCK ? raw.size() - offset : MAX_STORED_BLOCK;
+        last = offset + length == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(length & 0xFF);
+        idat.push_back(length >> 8);
+        idat.push_back(~length & 0xFF);
+        idat.push_back((~length >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    }
+    putU32(idat, adler32(raw.data(), raw.size()));
+
+    std::vector<uint8_t> header;
+    putU32(header, width);
+    putU32(header, height);
+    header.push_back(8);   // Bit depth
+    header.push_back(2);   // Truecolor
+    header.push_back(0);   // Deflate
+    header.push_back(0);   // Adaptive filtering
+    header.push_back(0);   // Not interlaced
+
+    std::vector<uint8_t> file(SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+    putChunk(file, "IHDR", header);
+    putChunk(file, "IDAT", idat);
+    putChunk(file, "IEND", {});
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        printf("[Png] Could not create %s\n", path.c_str());
+        return false;
+    }
+    bool ok = fwrite(file.data(), 1, file.size(), f) == file.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok) {
+        printf("[Png] Could not write %s\n", path.c_str());
+    }
+    return ok;
+}
+
+bool Png::read(const std::string& path, std::vector<uint8_t>& pixels,
+               uint16_t& width, uint16_t& height) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        printf("[Png] Could not open %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> file;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        file.insert(file.end(), chunk, chunk + n);
+    }
+    fclose(f);
+
+    if (file.size() < sizeof(SIGNATURE) || memcmp(file.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) {
+        printf("[Png] %s is not a PNG\n", path.c_str());
+        return false;
+    }
+
+    // Gather the header and image data
+    std::vector<uint8_t> idat;
+    uint32_t w = 0, h = 0;
+    bool have_header = false;
+    size_t pos = sizeof(SIGNATURE);
+    while (pos + 12 <= file.size()) {
+        uint32_t length = getU32(&file[pos]);
+        if (pos + 12 + length > file.size()) break;
+        const uint8_t* type = &file[pos + 4];
+        const uint8_t* data = &file[pos + 8];
+        if (getU32(data + length) != crc32(type, length + 4)) {
+            printf("[Png] %s has a corrupt chunk\n", path.c_str());
+            return false;
+        }
+        if (memcmp(type, "IHDR", 4) == 0 && length == 13) {
+            w = getU32(data);
+            h = getU32(data + 4);
+            if (data[8] != 8 || data[9] != 2 || data[12] != 0) {
+                printf("[Png] %s is not 8-bit RGB; re-record it\n", path.c_str());
+                return false;
+            }
+            have_header = true;
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            idat.insert(idat.end(), data, data + length);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + length;
+    }
+    if (!have_header || w == 0 || h == 0 || w > 0xFFFF || h > 0xFFFF || idat.size() < 2) {
+        printf("[Png] %s has no image\n", path.c_str());
+        return false;
+    }
+
+    // Unpack the stored blocks
+    std::vector<uint8_t> raw;
+    size_t in = 2;
+    bool last = false;
+    while (!last) {
+        if (in + 5 > idat.size() || (idat[in] & 0x06) != 0) {
+            printf("[Png] %s uses compressed blocks; re-record it\n", path.c_str());
+            return false;
+        }
+        last = idat[in] & 1;
+        size_t length = idat[in + 1] | (idat[in + 2] << 8);
+        in += 5;
+        if (in + length > idat.size()) {
+            printf("[Png] %s is truncated\n", path.c_str());
+            return false;
+        }
+        raw.insert(raw.end(), idat.begin() + in, idat.begin() + in + length);
+        in += length;
+    }
+
+    size_t row_bytes = 1 + (size_t)w * 3;
+    if (raw.size() != row_bytes * h) {
+        printf("[Png] %s has %zu bytes of pixels for a %ux%u image\n", path.c_str(), raw.size(), w, h);
+        return false;
+    }
+
+    width = w;
+    height = h;
+    pixels.assign((size_t)w * h * 2, 0);
+    for (uint32_t y = 0; y < h; ++y) {
+        const uint8_t* row = &raw[y * row_bytes];
+        if (row[0] != 0) {
+            printf("[Png] %s uses row filters; re-record it\n", path.c_str());
+            return false;
+        }
+        for (uint32_t x = 0; x < w; ++x) {
+            const uint8_t* rgb = &row[1 + x * 3];
+            uint16_t px = ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+            size_t i = ((size_t)y * w + x) * 2;
+            pixels[i] = px >> 8;
+            pixels[i + 1] = px & 0xFF;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads and writes panel framebuffers as 8-bit RGB PNGs
+ *
+ * Pixels are RGB565 high byte first, the order the panel receives them in,
+ * and are only unswapped into RGB here.
+ *
+ * Images are written with uncompressed deflate blocks, which keeps this free
+ * of zlib; read() accepts only such files, so goldens must be recorded by
+ * write() rather than re-saved by an image editor. RGB565 channels are
+ * widened by bit replication, so a written image reads back unchanged.
+ */
+class Png {
+public:
+    /**
+     * @brief Write an image
+     *
+     * @param path File to create or replace
+     * @param pixels width x height RGB565 pixels, row by row, high byte first
+     * @return true if the file was written
+     */
+    static bool write(const std::string& path, const std::vector<uint8_t>& pixels,
+                      uint16_t width, uint16_t height);
+
+    /**
+     * @brief Read an image written by write()
+     *
+     * @param path File to read
+     * @param pixels Receives the RGB565 pixels, high byte first
+     * @param width Receives the width
+     * @param height Receives the height
+     * @return true if the file was read; false with a message printed otherwise
+     */
+    static bool read(const std::string& path, std::vector<uint8_t>& pixels,
+                     uint16_t& width, uint16_t& height);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @file RenderSuites.h
+ * @brief Groups of tests in this suite's other files, run from main()
+ *
+ * Each function runs its tests with RUN_TEST, after lv_init().
+ */
+
+#include <string>
+
+/**
+ * @brief Read a recorded API response from fixtures/ (test_render.cpp)
+ *
+ * @return The file's contents, empty if it can't be read
+ */
+std::string readFixture(const char* name);
+
+/**
+ * @brief Byte order and cost of flushes (test_flush.cpp)
+ */
+void runFlushTests();
+
+/**
+ * @brief Double-buffered flushes through a DisplayPanel (test_panel.cpp)
+ */
+void runPanelTests();
+
+/**
+ * @brief Heap use of insight refreshes (test_allocations.cpp)
+ */
+void runAllocationTests();
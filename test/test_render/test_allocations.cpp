@@ -0,0 +1,195 @@
+/**
+ * @file test_allocations.cpp
+ * @brief Counts heap allocations across an insight refresh
+ *
+ * Replaces the global operator new to count every allocation, then runs
+ * each renderer fixture through a refresh the way the device does: parse
+ * the response, let the renderer build its update and dispatch it through a
+ * UIDispatchQueue, then drain the queue on the "LVGL thread".
+ *
+ * Parsing and building the update allocate by design (documents, point
+ * vectors), and those counts are only reported. The callback wrappers that
+ * carry the update, InlineFunction and the dispatch queue, must not
+ * allocate at all.
+ *
+ * Strings allocate with malloc, on the device as here, so they are not
+ * counted; they are captured data, not wrapper overhead.
+ */
+
+#include <unity.h>
+#include <lvgl.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include "HeadlessDisplay.h"
+#include "RenderSuites.h"
+#include "posthog/parsers/InsightParser.h"
+#include "ui/UIDispatchQueue.h"
+#include "ui/renderers/NumericCardRenderer.h"
+#include "ui/renderers/LineGraphRenderer.h"
+#include "ui/renderers/FunnelRenderer.h"
+
+namespace {
+
+std::atomic<size_t> allocations(0);
+
+size_t allocationsSince(size_t start) {
+    return allocations.load() - start;
+}
+
+void* countedAlloc(size_t size) {
+    allocations++;
+    return malloc(size ? size : 1);
+}
+
+/**
+ * @brief Allocations in each phase of one refresh
+ */
+struct RefreshAllocations {
+    size_t parse;      ///< Constructing the InsightParser
+    size_t update;     ///< updateDisplay(), dispatch included
+    size_t dispatch;   ///< Inside the dispatch hook: queueing the update
+    size_t drain;      ///< Running the queued update on the LVGL thread
+    size_t dispatched; ///< Updates the renderer dispatched
+};
+
+/**
+ * @brief Refresh a renderer from a fixture through a real UIDispatchQueue
+ */
+template <typename Renderer>
+RefreshAllocations refresh(const char* fixture) {
+    RefreshAllocations counts = {};
+    std::string json = readFixture(fixture);
+
+    HeadlessDisplay display;
+    UIDispatchQueue queue;
+
+    lv_obj_t* holder = lv_obj_create(display.screen());
+    lv_obj_set_size(holder, HeadlessDisplay::WIDTH, HeadlessDisplay::HEIGHT - 30);
+    Renderer renderer;
+    lv_obj_update_layout(holder);
+    renderer.createElements(holder);
+    lv_obj_update_layout(holder);
+    renderer.onLayoutReady();
+    display.run(LV_DEF_REFR_PERIOD);
+
+    // Route dispatches through the queue, as CardController does
+    InlineFunction<void(UITask, bool), 16> direct = std::move(globalUIDispatch);
+    InlineFunction<void(const UIUpdateKey&, UITask), 16> directKeyed = std::move(globalUIDispatchKeyed);
+    globalUIDispatch = [&queue, &counts](UITask task, bool urgent) {
+        size_t start = allocations.load();
+        queue.push(std::move(task), urgent);
+        counts.dispatch += allocationsSince(start);
+        counts.dispatched++;
+    };
+    globalUIDispatchKeyed = [&queue, &counts](const UIUpdateKey& key, UITask task) {
+        size_t start = allocations.load();
+        queue.pushKeyed(key, std::move(task));
+        counts.dispatch += allocationsSince(start);
+        counts.dispatched++;
+    };
+
+    size_t start = allocations.load();
+    InsightParser parser(json.c_str());
+    counts.parse = allocationsSince(start);
+
+    start = allocations.load();
+    renderer.updateDisplay(parser, String("Insight"), "", "");
+    counts.update = allocationsSince(start);
+
+    start = allocations.load();
+    queue.drain();
+    counts.drain = allocationsSince(start);
+
+    globalUIDispatch = std::move(direct);
+    globalUIDispatchKeyed = std::move(directKeyed);
+
+    display.run(LV_DEF_REFR_PERIOD);
+    renderer.clearElements();
+    return counts;
+}
+
+template <typename Renderer>
+void checkRefresh(const char* fixture) {
+    RefreshAllocations counts = refresh<Renderer>(fixture);
+
+    char line[160];
+    snprintf(line, sizeof(line), "%s: parse %zu, update %zu (dispatch %zu), drain %zu allocations",
+             fixture, counts.parse, counts.update, counts.dispatch, counts.drain);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(1, counts.dispatched, "One update per refresh");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, counts.dispatch, "Queueing an update must not allocate");
+    // The update bodies only call LVGL, which has its own pool, so what's left is the wrappers
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, counts.drain, "Running and destroying an update must not allocate");
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+void test_allocation_hook_counts() {
+    // A capture too big for std::function's small buffer: it must allocate, the UITask must not
+    struct Payload {
+        void* owner;
+        double values[4];
+    } payload = {};
+
+    size_t start = allocations.load();
+    std::function<void()> heap_task = [payload]() { (void)payload; };
+    size_t std_function = allocationsSince(start);
+
+    start = allocations.load();
+    UITask inline_task = [payload]() { (void)payload; };
+    UITask moved = std::move(inline_task);
+    moved();
+    moved.reset();
+    size_t ui_task = allocationsSince(start);
+
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, std_function, "The hook should see std::function allocate");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, ui_task, "A UITask must hold the same capture inline");
+}
+
+void test_numeric_refresh_allocations() {
+    checkRefresh<NumericCardRenderer>("numeric.json");
+}
+
+void test_line_graph_refresh_allocations() {
+    checkRefresh<LineGraphRenderer>("line_graph.json");
+}
+
+void test_funnel_refresh_allocations() {
+    checkRefresh<FunnelRenderer>("funnel.json");
+}
+
+void runAllocationTests() {
+    RUN_TEST(test_allocation_hook_counts);
+    RUN_TEST(test_numeric_refresh_allocations);
+    RUN_TEST(test_line_graph_refresh_allocations);
+    RUN_TEST(test_funnel_refresh_allocations);
+}
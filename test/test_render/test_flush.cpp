@@ -0,0 +1,133 @@
+/**
+ * @file test_flush.cpp
+ * @brief Checks the bytes LVGL hands to flush and what a full frame costs
+ *
+ * The panel reads RGB565 high byte first, and DisplayInterface sends render
+ * buffers to it as-is, so LVGL must render in that order itself.
+ */
+
+#include <unity.h>
+#include <lvgl.h>
+#include <cstdio>
+#include "HeadlessDisplay.h"
+#include "RenderSuites.h"
+
+namespace {
+
+const uint32_t FRAME_PX = (uint32_t)HeadlessDisplay::WIDTH * HeadlessDisplay::HEIGHT;
+const int BENCHMARK_FRAMES = 20;
+
+/**
+ * @brief A colour and the two bytes the panel must receive for it
+ *
+ * Channels use only the bits RGB565 keeps, so conversion is exact.
+ */
+struct KnownColor {
+    const char* name;
+    uint8_t r, g, b;
+    uint8_t high, low;
+};
+
+const KnownColor COLORS[] = {
+    {"red",   0xF8, 0x00, 0x00, 0xF8, 0x00},
+    {"green", 0x00, 0xFC, 0x00, 0x07, 0xE0},
+    {"blue",  0x00, 0x00, 0xF8, 0x00, 0x1F},
+    {"mixed", 0x10, 0x24, 0x38, 0x11, 0x27},   // Bytes differ, so a missing swap shows
+    {"white", 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+};
+
+/**
+ * @brief Create an unstyled rectangle of one colour
+ */
+lv_obj_t* createRect(lv_obj_t* parent, const KnownColor& color, int32_t x, int32_t w) {
+    lv_obj_t* rect = lv_obj_create(parent);
+    lv_obj_remove_style_all(rect);
+    lv_obj_set_pos(rect, x, 0);
+    lv_obj_set_size(rect, w, HeadlessDisplay::HEIGHT);
+    lv_obj_set_style_bg_color(rect, lv_color_make(color.r, color.g, color.b), 0);
+    lv_obj_set_style_bg_opa(rect, LV_OPA_COVER, 0);
+    return rect;
+}
+
+/**
+ * @brief Check every pixel of some columns against a colour
+ *
+ * @return Number of pixels whose bytes differ
+ */
+size_t countMismatches(const std::vector<uint8_t>& framebuffer, const KnownColor& color, int32_t x, int32_t w) {
+    size_t mismatched = 0;
+    for (int32_t y = 0; y < HeadlessDisplay::HEIGHT; ++y) {
+        for (int32_t col = x; col < x + w; ++col) {
+            size_t i = ((size_t)y * HeadlessDisplay::WIDTH + col) * HeadlessDisplay::BYTES_PER_PIXEL;
+            if (framebuffer[i] != color.high || framebuffer[i + 1] != color.low) {
+                mismatched++;
+            }
+        }
+    }
+    return mismatched;
+}
+
+} // namespace
+
+void test_flush_bytes_are_high_byte_first() {
+    const size_t count = sizeof(COLORS) / sizeof(COLORS[0]);
+    const int32_t strip = HeadlessDisplay::WIDTH / count;
+
+    size_t mismatched[count] = {};
+    FrameStats stats;
+    {
+        HeadlessDisplay display;
+        for (size_t i = 0; i < count; ++i) {
+            createRect(display.screen(), COLORS[i], i * strip, strip);
+        }
+        display.run(LV_DEF_REFR_PERIOD);
+        stats = display.takeStats();
+
+        for (size_t i = 0; i < count; ++i) {
+            mismatched[i] = countMismatches(display.framebuffer(), COLORS[i], i * strip, strip);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(FRAME_PX, stats.flushed_px, "First frame should flush the whole screen");
+    for (size_t i = 0; i < count; ++i) {
+        char message[96];
+        snprintf(message, sizeof(message), "%s should reach flush as %02X %02X",
+                 COLORS[i].name, COLORS[i].high, COLORS[i].low);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, mismatched[i], message);
+    }
+}
+
+void test_full_frame_flush_cost() {
+    FrameStats total = {};
+    {
+        HeadlessDisplay display;
+        createRect(display.screen(), COLORS[3], 0, HeadlessDisplay::WIDTH);
+        display.run(LV_DEF_REFR_PERIOD);
+        display.takeStats();
+
+        for (int frame = 0; frame < BENCHMARK_FRAMES; ++frame) {
+            lv_obj_invalidate(display.screen());
+            display.run(LV_DEF_REFR_PERIOD);
+            FrameStats stats = display.takeStats();
+            total.frames += stats.frames;
+            total.render_us += stats.render_us;
+            total.flush_us += stats.flush_us;
+            total.flushed_px += stats.flushed_px;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(BENCHMARK_FRAMES, total.frames, "One render per invalidated frame");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(FRAME_PX * BENCHMARK_FRAMES, total.flushed_px, "Every frame flushes the whole screen");
+
+    char line[160];
+    snprintf(line, sizeof(line), "Full %ux%u frame: flush %u us, render %u us (mean of %d, %u bands each)",
+             HeadlessDisplay::WIDTH, HeadlessDisplay::HEIGHT, total.flush_us / BENCHMARK_FRAMES,
+             total.render_us / BENCHMARK_FRAMES, BENCHMARK_FRAMES,
+             (HeadlessDisplay::HEIGHT + HeadlessDisplay::BUFFER_ROWS - 1) / HeadlessDisplay::BUFFER_ROWS);
+    TEST_MESSAGE(line);
+}
+
+void runFlushTests() {
+    RUN_TEST(test_flush_bytes_are_high_byte_first);
+    RUN_TEST(test_full_frame_flush_cost);
+}
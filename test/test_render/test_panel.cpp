@@ -0,0 +1,75 @@
+/**
+ * @file test_panel.cpp
+ * @brief Checks that LVGL renders while the panel is still sending
+ *
+ * DisplayInterface queues each band on the panel and returns, so LVGL can
+ * render the next band into its other buffer while the previous one is on
+ * the wire. MockPanel takes as long as the SPI bus would and records when
+ * LVGL had to wait for it.
+ */
+
+#include <unity.h>
+#include <lvgl.h>
+#include <cstdio>
+#include "HeadlessDisplay.h"
+#include "MockPanel.h"
+#include "RenderSuites.h"
+
+namespace {
+
+// Slower than the device's 40 MHz, so a band is in flight far longer than it takes to render
+const uint32_t PIXEL_CLOCK_HZ = 10000000;
+const size_t BANDS = (HeadlessDisplay::HEIGHT + HeadlessDisplay::BUFFER_ROWS - 1) / HeadlessDisplay::BUFFER_ROWS;
+
+} // namespace
+
+void test_next_band_renders_while_previous_in_flight() {
+    MockPanel panel(PIXEL_CLOCK_HZ);
+    std::vector<MockPanel::Window> windows;
+    {
+        HeadlessDisplay display(&panel);
+        lv_obj_t* label = lv_label_create(display.screen());
+        lv_obj_set_style_text_color(label, lv_color_white(), 0);
+        lv_label_set_text(label, "DeskHog");
+        lv_obj_center(label);
+
+        display.run(LV_DEF_REFR_PERIOD);
+    }
+    // The display waited for the last band as it closed
+    windows = panel.windows();
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(BANDS, windows.size(), "One window per band of the first frame");
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const MockPanel::Window& window = windows[i];
+        TEST_ASSERT_EQUAL_INT(0, window.x);
+        TEST_ASSERT_EQUAL_INT(i * HeadlessDisplay::BUFFER_ROWS, window.y);
+        TEST_ASSERT_EQUAL_INT(HeadlessDisplay::WIDTH, window.w);
+        if (i == 0) {
+            continue;
+        }
+
+        const MockPanel::Window& previous = windows[i - 1];
+        char message[96];
+        snprintf(message, sizeof(message), "Band %u should render while band %u is in flight", (unsigned)i, (unsigned)(i - 1));
+        TEST_ASSERT_TRUE_MESSAGE(previous.rendered_next_in_flight, message);
+        snprintf(message, sizeof(message), "Band %u should use the other buffer than band %u", (unsigned)i, (unsigned)(i - 1));
+        TEST_ASSERT_TRUE_MESSAGE(window.pixels != previous.pixels, message);
+        snprintf(message, sizeof(message), "Band %u should be queued only once band %u was sent", (unsigned)i, (unsigned)(i - 1));
+        TEST_ASSERT_TRUE_MESSAGE(previous.done_us != 0 && previous.done_us <= window.queued_us, message);
+    }
+
+    // With rendering hidden behind transfers, a frame takes little more than its transfers
+    uint32_t transfer_us = 0;
+    for (const MockPanel::Window& window : windows) {
+        transfer_us += (uint64_t)window.w * window.h * 16 * 1000000 / PIXEL_CLOCK_HZ;
+    }
+    const MockPanel::Window& last = windows.back();
+    char line[128];
+    snprintf(line, sizeof(line), "Frame sent in %u us, of which %u us transfers; last band queued at %u us",
+             last.done_us - windows.front().queued_us, transfer_us, last.queued_us - windows.front().queued_us);
+    TEST_MESSAGE(line);
+}
+
+void runPanelTests() {
+    RUN_TEST(test_next_band_renders_while_previous_in_flight);
+}
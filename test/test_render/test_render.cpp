@@ -0,0 +1,374 @@
+/**
+ * @file test_render.cpp
+ * @brief Renders cards headless and compares them against golden images
+ *
+ * Each test builds a card on a HeadlessDisplay, feeding insight renderers a
+ * recorded API response from fixtures/. It reports render time, flush time
+ * and invalidated area for building the card and for its update, then
+ * compares the framebuffer against golden/<name>.png.
+ *
+ * Frames are compared in the bytes the panel is sent. A missing golden
+ * fails the test. Set RENDER_UPDATE_GOLDEN to record every golden instead,
+ * which ignores the comparisons; commit the recorded images. On a mismatch
+ * the actual image and a diff are written to out/.
+ *
+ * Run with: pio test -e native
+ */
+
+#include <unity.h>
+#include <lvgl.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "HeadlessDisplay.h"
+#include "Png.h"
+#include "RenderSuites.h"
+#include "Style.h"
+#include "posthog/parsers/InsightParser.h"
+#include "ui/renderers/NumericCardRenderer.h"
+#include "ui/renderers/LineGraphRenderer.h"
+#include "ui/renderers/FunnelRenderer.h"
+#include "ui/FriendCard.h"
+#include "ui/ProvisioningCard.h"
+
+// CardController sets these on the device; here the test is the LVGL thread
+InlineFunction<void(UITask, bool), 16> globalUIDispatch = [](UITask task, bool) { task(); };
+InlineFunction<void(const UIUpdateKey&, UITask), 16> globalUIDispatchKeyed = [](const UIUpdateKey&, UITask task) { task(); };
+InlineFunction<void(const void*), 16> globalUICancel = [](const void*) {};
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint32_t SETTLE_MS = 600;   ///< Long enough for style transitions to finish
+
+enum class GoldenResult {
+    MATCH,
+    RECORDED,
+    MISMATCH,
+    ERROR
+};
+
+fs::path suiteDir() {
+    return fs::path(__FILE__).parent_path();
+}
+
+void report(const char* phase, const FrameStats& stats) {
+    char line[192];
+    snprintf(line, sizeof(line),
+             "%s: %u frames, render %u us (max %u), flush %u us, invalidated %u px, flushed %u px",
+             phase, stats.frames, stats.render_us, stats.max_render_us, stats.flush_us,
+             stats.invalidated_px, stats.flushed_px);
+    TEST_MESSAGE(line);
+}
+
+/**
+ * @brief Compare a framebuffer with its golden image, recording it if asked
+ *
+ * @param pixels Framebuffer to check, as the panel receives it
+ * @param name Golden image name, without extension
+ * @param detail Receives a message for anything other than a match
+ */
+GoldenResult compareGolden(const std::vector<uint8_t>& pixels, const char* name, std::string& detail) {
+    const uint16_t width = HeadlessDisplay::WIDTH;
+    const uint16_t height = HeadlessDisplay::HEIGHT;
+    fs::path golden = suiteDir() / "golden" / (std::string(name) + ".png");
+    std::error_code ec;
+
+    if (getenv("RENDER_UPDATE_GOLDEN")) {
+        fs::create_directories(golden.parent_path(), ec);
+        if (!Png::write(golden.string(), pixels, width, height)) {
+            detail = "Could not record " + golden.string();
+            return GoldenResult::ERROR;
+        }
+        detail = "Recorded " + golden.string();
+        return GoldenResult::RECORDED;
+    }
+
+    if (!fs::exists(golden)) {
+        detail = golden.string() + " is missing; record it with RENDER_UPDATE_GOLDEN=1";
+        return GoldenResult::ERROR;
+    }
+
+    std::vector<uint8_t> expected;
+    uint16_t golden_width = 0, golden_height = 0;
+    if (!Png::read(golden.string(), expected, golden_width, golden_height)) {
+        detail = "Could not read " + golden.string();
+        return GoldenResult::ERROR;
+    }
+    if (golden_width != width || golden_height != height) {
+        detail = golden.string() + " is not " + std::to_string(width) + "x" + std::to_string(height);
+        return GoldenResult::ERROR;
+    }
+
+    // Mismatches in red over a dimmed copy of the frame
+    std::vector<uint8_t> diff(pixels.size());
+    size_t mismatched = 0;
+    int min_x = width, min_y = height, max_x = -1, max_y = -1;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = ((size_t)y * width + x) * HeadlessDisplay::BYTES_PER_PIXEL;
+            uint16_t px = (pixels[i] << 8) | pixels[i + 1];
+            if (px != ((expected[i] << 8) | expected[i + 1])) {
+                px = 0xF800;
+                mismatched++;
+                min_x = std::min(min_x, x);
+                min_y = std::min(min_y, y);
+                max_x = std::max(max_x, x);
+                max_y = std::max(max_y, y);
+            } else {
+                px = (px >> 2) & 0x39E7;
+            }
+            diff[i] = px >> 8;
+            diff[i + 1] = px & 0xFF;
+        }
+    }
+    if (mismatched == 0) {
+        return GoldenResult::MATCH;
+    }
+
+    fs::path out = suiteDir() / "out";
+    fs::create_directories(out, ec);
+    Png::write((out / (std::string(name) + ".png")).string(), pixels, width, height);
+    Png::write((out / (std::string(name) + ".diff.png")).string(), diff, width, height);
+
+    char message[192];
+    snprintf(message, sizeof(message), "%zu pixels differ from golden/%s.png in (%d,%d)-(%d,%d); see out/%s.png",
+             mismatched, name, min_x, min_y, max_x, max_y, name);
+    detail = message;
+    return GoldenResult::MISMATCH;
+}
+
+/**
+ * @brief Fail or ignore the test for a golden comparison
+ *
+ * Called once the display and cards are gone, as Unity leaves the test
+ * without running destructors.
+ */
+void finishGolden(GoldenResult result, const std::string& detail) {
+    switch (result) {
+        case GoldenResult::MATCH:
+            break;
+        case GoldenResult::RECORDED:
+            TEST_IGNORE_MESSAGE(detail.c_str());
+            break;
+        case GoldenResult::MISMATCH:
+        case GoldenResult::ERROR:
+            TEST_FAIL_MESSAGE(detail.c_str());
+            break;
+    }
+}
+
+/**
+ * @brief Build the frame InsightCard puts around a renderer
+ *
+ * Mirrors InsightCard's constructor and activateRenderer(): a title row
+ * above a holder that fills the rest of the card.
+ *
+ * @return The holder to create the renderer's elements in
+ */
+lv_obj_t* createInsightFrame(lv_obj_t* parent, const char* title) {
+    lv_obj_t* card = lv_obj_create(parent);
+    lv_obj_set_size(card, HeadlessDisplay::WIDTH, HeadlessDisplay::HEIGHT);
+    lv_obj_set_style_bg_color(card, Style::backgroundColor(), 0);
+    lv_obj_set_style_pad_all(card, 0, 0);
+    lv_obj_set_style_border_width(card, 0, 0);
+    lv_obj_set_style_radius(card, 0, 0);
+
+    lv_obj_t* flex_col = lv_obj_create(card);
+    lv_obj_set_size(flex_col, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_pad_all(flex_col, 5, 0);
+    lv_obj_set_style_pad_row(flex_col, 5, 0);
+    lv_obj_set_flex_flow(flex_col, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(flex_col, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(flex_col, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_opa(flex_col, LV_OPA_0, 0);
+    lv_obj_set_style_border_width(flex_col, 0, 0);
+
+    lv_obj_t* title_label = lv_label_create(flex_col);
+    lv_obj_set_width(title_label, lv_pct(100));
+    lv_obj_set_style_text_color(title_label, Style::labelColor(), 0);
+    lv_obj_set_style_text_font(title_label, Style::labelFont(), 0);
+    lv_label_set_long_mode(title_label, LV_LABEL_LONG_DOT);
+    lv_label_set_text(title_label, title);
+
+    lv_obj_t* content = lv_obj_create(flex_col);
+    lv_obj_set_width(content, lv_pct(100));
+    lv_obj_set_flex_grow(content, 1);
+    lv_obj_set_style_bg_opa(content, LV_OPA_0, 0);
+    lv_obj_set_style_border_width(content, 0, 0);
+    lv_obj_set_style_pad_all(content, 0, 0);
+
+    lv_obj_t* holder = lv_obj_create(content);
+    lv_obj_set_size(holder, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_bg_opa(holder, LV_OPA_0, 0);
+    lv_obj_set_style_border_width(holder, 0, 0);
+    lv_obj_set_style_pad_all(holder, 0, 0);
+    lv_obj_clear_flag(holder, LV_OBJ_FLAG_SCROLLABLE);
+    return holder;
+}
+
+/**
+ * @brief Render a fixture the way InsightCard does and check it against its golden
+ *
+ * @param fixture File in fixtures/
+ * @param type Type the parser must detect in the fixture
+ * @param golden Golden image name
+ */
+template <typename Renderer>
+void renderInsight(const char* fixture, InsightParser::InsightType type, const char* golden) {
+    std::string json = readFixture(fixture);
+    TEST_ASSERT_FALSE_MESSAGE(json.empty(), fixture);
+    InsightParser parser(json.c_str());
+    TEST_ASSERT_TRUE_MESSAGE(parser.isValid(), fixture);
+    TEST_ASSERT_EQUAL_INT_MESSAGE((int)type, (int)parser.getInsightType(), fixture);
+
+    char title[64];
+    if (!parser.getName(title, sizeof(title))) {
+        strcpy(title, "Insight");
+    }
+    char prefix[16] = "";
+    char suffix[16] = "";
+    if (type == InsightParser::InsightType::NUMERIC_CARD) {
+        parser.getNumericFormattingPrefix(prefix, sizeof(prefix));
+        parser.getNumericFormattingSuffix(suffix, sizeof(suffix));
+    }
+
+    GoldenResult result;
+    std::string detail;
+    {
+        HeadlessDisplay display;
+        lv_obj_t* holder = createInsightFrame(display.screen(), title);
+        Renderer renderer;
+
+        lv_obj_update_layout(holder);
+        renderer.createElements(holder);
+        lv_obj_update_layout(holder);
+        renderer.onLayoutReady();
+        display.run(SETTLE_MS);
+        report("build", display.takeStats());
+
+        renderer.updateDisplay(parser, String(title), prefix, suffix);
+        display.run(SETTLE_MS);
+        report("update", display.takeStats());
+
+        result = compareGolden(display.framebuffer(), golden, detail);
+        renderer.clearElements();
+    }
+    finishGolden(result, detail);
+}
+
+} // namespace
+
+std::string readFixture(const char* name) {
+    std::ifstream in(suiteDir() / "fixtures" / name, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_numeric_card() {
+    renderInsight<NumericCardRenderer>("numeric.json", InsightParser::InsightType::NUMERIC_CARD, "numeric");
+}
+
+void test_line_graph() {
+    renderInsight<LineGraphRenderer>("line_graph.json", InsightParser::InsightType::LINE_GRAPH, "line_graph");
+}
+
+void test_funnel() {
+    renderInsight<FunnelRenderer>("funnel.json", InsightParser::InsightType::FUNNEL, "funnel");
+}
+
+void test_friend_card() {
+    GoldenResult result;
+    std::string detail;
+    {
+        HeadlessDisplay display;
+        FriendCard card(display.screen());
+        display.run(SETTLE_MS);
+        report("build", display.takeStats());
+
+        card.cycleNextMessage();
+        display.run(SETTLE_MS);
+        report("next message", display.takeStats());
+
+        result = compareGolden(display.framebuffer(), "friend", detail);
+        // The display deletes the card's objects
+        card.prepareForRemoval();
+    }
+    finishGolden(result, detail);
+}
+
+void test_provisioning_qr_code() {
+    SystemController::state().wifi_state = WifiState::AP_MODE;
+    SystemController::state().api_state = ApiState::API_AWAITING_CONFIG;
+    WiFiInterface wifi("DeskHog_A1B2C3D4");
+
+    GoldenResult result;
+    std::string detail;
+    {
+        HeadlessDisplay display;
+        ProvisioningCard card(display.screen(), wifi, HeadlessDisplay::WIDTH, HeadlessDisplay::HEIGHT);
+        display.run(SETTLE_MS);
+        report("build", display.takeStats());
+
+        card.showQRCode();
+        display.run(SETTLE_MS);
+        report("qr code", display.takeStats());
+
+        result = compareGolden(display.framebuffer(), "provisioning_qr", detail);
+    }
+    finishGolden(result, detail);
+}
+
+void test_provisioning_status() {
+    SystemController::state().wifi_state = WifiState::CONNECTING;
+    SystemController::state().api_state = ApiState::API_CONFIGURED;
+    WiFiInterface wifi("Office");
+
+    GoldenResult result;
+    std::string detail;
+    {
+        HeadlessDisplay display;
+        ProvisioningCard card(display.screen(), wifi, HeadlessDisplay::WIDTH, HeadlessDisplay::HEIGHT);
+        display.run(SETTLE_MS);
+        report("build", display.takeStats());
+
+        card.updateConnectionStatus("Connecting...");
+        card.updateIPAddress("192.168.1.42");
+        card.updateSignalStrength(72);
+        display.run(SETTLE_MS);
+        report("status", display.takeStats());
+
+        result = compareGolden(display.framebuffer(), "provisioning_status", detail);
+    }
+    finishGolden(result, detail);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    lv_init();
+    Style::init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_numeric_card);
+    RUN_TEST(test_line_graph);
+    RUN_TEST(test_funnel);
+    RUN_TEST(test_friend_card);
+    RUN_TEST(test_provisioning_qr_code);
+    RUN_TEST(test_provisioning_status);
+    runFlushTests();
+    runPanelTests();
+    runAllocationTests();
+    return UNITY_END();
+}